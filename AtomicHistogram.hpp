@@ -0,0 +1,141 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_ATOMICHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_ATOMICHISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Common.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+
+// elements between hot set refreshes, and how many of them are sampled to pick the hot set.
+constexpr size_t ATOMIC_BLOCK_ELEMENTS = 64 * 1024;
+constexpr size_t ATOMIC_SAMPLE_SIZE    = 256;
+// a bin is hot once it shows up this often in the sample, ~3% of the block.
+constexpr size_t ATOMIC_HOT_THRESHOLD  = 8;
+constexpr size_t ATOMIC_HOT_BINS       = 16;
+// direct mapped tag table the hot bins are looked up in, sparse so hot bins rarely collide.
+constexpr size_t ATOMIC_HOT_SLOTS      = 64;
+static_assert(std::has_single_bit(ATOMIC_HOT_SLOTS));
+
+// Per thread hot bin cache. Hot bins are counted privately and flushed with one atomic add per block,
+// everything else goes straight to the shared histogram.
+struct HotBinCache {
+    std::array<int, ATOMIC_HOT_SLOTS> tags;
+    std::array<int, ATOMIC_HOT_SLOTS> counts;
+    bool any = false;
+
+    static size_t slot(const int bin) {
+        return (static_cast<uint32_t>(bin) * 2654435761u) >> (32 - std::countr_zero(ATOMIC_HOT_SLOTS));
+    }
+
+    // picks the bins that dominate an evenly spaced sample of the block.
+    void refresh(const int* data, const size_t count) {
+        tags.fill(-1);
+        counts.fill(0);
+        any = false;
+        if (count < ATOMIC_SAMPLE_SIZE * 4) return;
+
+        std::array<int, ATOMIC_SAMPLE_SIZE> sample;
+        const size_t stride = count / ATOMIC_SAMPLE_SIZE;
+        for (size_t i = 0; i < ATOMIC_SAMPLE_SIZE; ++i) {
+            sample[i] = data[i * stride];
+        }
+        std::sort(sample.begin(), sample.end());
+
+        size_t hot = 0;
+        for (size_t i = 0; i < ATOMIC_SAMPLE_SIZE && hot < ATOMIC_HOT_BINS;) {
+            size_t run = 1;
+            while (i + run < ATOMIC_SAMPLE_SIZE && sample[i + run] == sample[i]) ++run;
+            if (run >= ATOMIC_HOT_THRESHOLD && tags[slot(sample[i])] == -1) {
+                tags[slot(sample[i])] = sample[i];
+                ++hot;
+            }
+            i += run;
+        }
+        any = hot != 0;
+    }
+
+    void flush(int* histogram) {
+        for (size_t s = 0; s < ATOMIC_HOT_SLOTS; ++s) {
+            if (counts[s] != 0) {
+                std::atomic_ref(histogram[tags[s]]).fetch_add(counts[s], std::memory_order_relaxed);
+                counts[s] = 0;
+            }
+        }
+    }
+};
+
+// every thread updates the one shared histogram with relaxed atomic adds, no private copies. histogram
+// must be zeroed by the caller. HotBins enables the privatized hot bin cache.
+template<bool HotBins = true, typename Pool = ThreadPool>
+void solveThreadedAtomicHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram,
+    const size_t dataSize, const size_t threadAmount, Pool& pool) {
+    static_assert(std::atomic_ref<int>::required_alignment <= alignof(int));
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &data, &histogram](const size_t t) {
+        int* hist = histogram.get();
+        const int* in = data.get();
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+
+        if constexpr (!HotBins) {
+            for (size_t i = start; i < end; ++i) {
+                std::atomic_ref(hist[in[i]]).fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        HotBinCache cache;
+        for (size_t blockStart = start; blockStart < end; blockStart += ATOMIC_BLOCK_ELEMENTS) {
+            const size_t blockEnd = std::min(blockStart + ATOMIC_BLOCK_ELEMENTS, end);
+            cache.refresh(in + blockStart, blockEnd - blockStart);
+
+            if (!cache.any) {
+                for (size_t i = blockStart; i < blockEnd; ++i) {
+                    std::atomic_ref(hist[in[i]]).fetch_add(1, std::memory_order_relaxed);
+                }
+                continue;
+            }
+
+            for (size_t i = blockStart; i < blockEnd; ++i) {
+                const int value = in[i];
+                const size_t s = HotBinCache::slot(value);
+                if (cache.tags[s] == value) {
+                    ++cache.counts[s];
+                } else {
+                    std::atomic_ref(hist[value]).fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            cache.flush(hist);
+        }
+    }).wait();
+}
+
+template<bool HotBins = true, typename Pool = ThreadPool>
+void profile_threaded_atomic_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, Pool& pool) {
+    // warmup
+    clear(testHistogram.get(), maxVal);
+    solveThreadedAtomicHistogram<HotBins>(data, testHistogram, dataSize, threadAmount, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveThreadedAtomicHistogram<HotBins>(data, testHistogram, dataSize, threadAmount, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
+
+#endif //CUDAHISTOGRAMS_ATOMICHISTOGRAM_HPP
@@ -0,0 +1,337 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "BenchmarkResults.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "BenchmarkStats.hpp"
+#include "PerfCounters.hpp"
+#include "Timer.hpp"
+
+namespace {
+    const std::vector<std::string> CSV_COLUMNS = {
+        "git_hash", "test", "threads", "bins", "elements", "workload", "element_bytes", "iterations",
+        "first_ms", "min_ms", "median_ms", "mean_ms", "p95_ms", "stddev_ms",
+        "elements_per_s", "gb_per_s"
+    };
+
+    std::string counterColumn(const perf::Event event) {
+        return std::string(perf::eventName(event)) + "_per_element";
+    }
+
+    using RecordKey = std::tuple<std::string, size_t, size_t, size_t, std::string>;
+
+    RecordKey keyOf(const BenchmarkRecord& record) {
+        return {record.testName, record.threadCount, record.binSize, record.dataSize, record.workload};
+    }
+
+    // throughput is taken from the median run.
+    double elementsPerSecond(const BenchmarkRecord& record, const stats::Summary& summary) {
+        return summary.median > 0.0 ? static_cast<double>(record.dataSize) / (summary.median / 1000.0) : 0.0;
+    }
+
+    double gigabytesPerSecond(const BenchmarkRecord& record, const stats::Summary& summary) {
+        return elementsPerSecond(record, summary) * static_cast<double>(record.elementBytes) / 1e9;
+    }
+
+    std::string csvQuote(const std::string& field) {
+        if (field.find_first_of(",\"\n") == std::string::npos) return field;
+        std::string quoted = "\"";
+        for (const char c : field) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    std::vector<std::string> csvSplit(const std::string& line) {
+        std::vector<std::string> fields(1);
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i) {
+            const char c = line[i];
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                    fields.back() += '"';
+                    ++i;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    fields.back() += c;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else if (c != '\r') {
+                fields.back() += c;
+            }
+        }
+        return fields;
+    }
+
+    std::string jsonEscape(const std::string& s) {
+        std::string escaped;
+        for (const char c : s) {
+            switch (c) {
+                case '"':  escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n";  break;
+                default:   escaped += c;
+            }
+        }
+        return escaped;
+    }
+}
+
+std::vector<BenchmarkRecord> collectBenchmarkRecords() {
+    std::lock_guard<std::mutex> lock(timing::mutex());
+
+    std::vector<BenchmarkRecord> records;
+    for (const auto& [key, total] : timing::totals()) {
+        BenchmarkRecord record;
+        record.testName = key.testName;
+        record.threadCount = key.threadCount;
+        record.binSize = key.binSize;
+        record.dataSize = key.dataSize;
+        record.workload = key.workload;
+        if (const auto it = timing::elementBytes().find(key); it != timing::elementBytes().end()) {
+            record.elementBytes = it->second;
+        }
+        if (const auto it = timing::samples().find(key); it != timing::samples().end()) {
+            record.samples = it->second;
+        } else {
+            record.samples = {total};
+        }
+        if (const auto it = timing::counters().find(key); it != timing::counters().end()) {
+            for (size_t e = 0; e < perf::EVENT_COUNT; ++e) {
+                if (!it->second.valid[e]) continue;
+                record.counterRates[perf::eventName(static_cast<perf::Event>(e))] =
+                    stats::perElement(it->second.values[e], record.samples.size(), record.dataSize);
+            }
+        }
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+void writeBenchmarkCsv(std::ostream& os, const std::string& gitHash, const std::vector<BenchmarkRecord>& records) {
+    for (size_t c = 0; c < CSV_COLUMNS.size(); ++c) {
+        os << (c ? "," : "") << CSV_COLUMNS[c];
+    }
+    for (size_t e = 0; e < perf::EVENT_COUNT; ++e) {
+        os << "," << counterColumn(static_cast<perf::Event>(e));
+    }
+    os << ",samples_ms\n";
+
+    os << std::setprecision(6);
+    for (const auto& record : records) {
+        const stats::Summary s = stats::summarize(record.samples);
+        os << csvQuote(gitHash) << "," << csvQuote(record.testName) << ","
+           << record.threadCount << "," << record.binSize << "," << record.dataSize << "," << csvQuote(record.workload) << "," << record.elementBytes << ","
+           << s.count << "," << s.first << "," << s.min << "," << s.median << "," << s.mean << "," << s.p95 << "," << s.stddev << ","
+           << elementsPerSecond(record, s) << "," << gigabytesPerSecond(record, s) << ",";
+        for (size_t e = 0; e < perf::EVENT_COUNT; ++e) {
+            if (const auto it = record.counterRates.find(perf::eventName(static_cast<perf::Event>(e))); it != record.counterRates.end()) {
+                os << it->second;
+            }
+            os << ",";
+        }
+        for (size_t i = 0; i < record.samples.size(); ++i) {
+            os << (i ? ";" : "") << record.samples[i];
+        }
+        os << "\n";
+    }
+}
+
+void writeBenchmarkJson(std::ostream& os, const std::string& gitHash, const std::vector<BenchmarkRecord>& records) {
+    os << std::setprecision(6);
+    os << "{\n  \"git_hash\": \"" << jsonEscape(gitHash) << "\",\n  \"results\": [";
+    for (size_t r = 0; r < records.size(); ++r) {
+        const auto& record = records[r];
+        const stats::Summary s = stats::summarize(record.samples);
+        os << (r ? "," : "") << "\n    {"
+           << "\"test\": \"" << jsonEscape(record.testName) << "\", "
+           << "\"threads\": " << record.threadCount << ", "
+           << "\"bins\": " << record.binSize << ", "
+           << "\"elements\": " << record.dataSize << ", "
+           << "\"workload\": \"" << jsonEscape(record.workload) << "\", "
+           << "\"element_bytes\": " << record.elementBytes << ", "
+           << "\"iterations\": " << s.count << ", "
+           << "\"first_ms\": " << s.first << ", "
+           << "\"min_ms\": " << s.min << ", "
+           << "\"median_ms\": " << s.median << ", "
+           << "\"mean_ms\": " << s.mean << ", "
+           << "\"p95_ms\": " << s.p95 << ", "
+           << "\"stddev_ms\": " << s.stddev << ", "
+           << "\"elements_per_s\": " << elementsPerSecond(record, s) << ", "
+           << "\"gb_per_s\": " << gigabytesPerSecond(record, s) << ", "
+           << "\"counters_per_element\": {";
+        bool firstCounter = true;
+        for (const auto& [name, rate] : record.counterRates) {
+            os << (firstCounter ? "" : ", ") << "\"" << name << "\": " << rate;
+            firstCounter = false;
+        }
+        os << "}, \"samples_ms\": [";
+        for (size_t i = 0; i < record.samples.size(); ++i) {
+            os << (i ? ", " : "") << record.samples[i];
+        }
+        os << "]}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+bool writeBenchmarkResults(const std::string& basePath, const std::string& gitHash) {
+    const auto records = collectBenchmarkRecords();
+
+    std::ofstream csv(basePath + ".csv");
+    std::ofstream json(basePath + ".json");
+    if (!csv || !json) return false;
+
+    writeBenchmarkCsv(csv, gitHash, records);
+    writeBenchmarkJson(json, gitHash, records);
+    return static_cast<bool>(csv) && static_cast<bool>(json);
+}
+
+std::vector<BenchmarkRecord> readBenchmarkCsv(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Could not open results file " + path);
+    }
+
+    std::string line;
+    if (!std::getline(in, line)) {
+        throw std::runtime_error("Results file " + path + " is empty");
+    }
+
+    // columns are looked up by name so files with extra columns still load.
+    std::map<std::string, size_t> column;
+    const auto header = csvSplit(line);
+    for (size_t c = 0; c < header.size(); ++c) {
+        column[header[c]] = c;
+    }
+    for (const char* required : {"test", "threads", "bins", "elements", "samples_ms"}) {
+        if (!column.count(required)) {
+            throw std::runtime_error("Results file " + path + " has no " + required + " column");
+        }
+    }
+
+    std::vector<BenchmarkRecord> records;
+    size_t lineNumber = 1;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line == "\r") continue;
+
+        const auto fields = csvSplit(line);
+        if (fields.size() < header.size()) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + " has too few fields");
+        }
+
+        try {
+            BenchmarkRecord record;
+            record.testName = fields[column["test"]];
+            record.threadCount = std::stoull(fields[column["threads"]]);
+            record.binSize = std::stoull(fields[column["bins"]]);
+            record.dataSize = std::stoull(fields[column["elements"]]);
+            // files from before the workload column only ran uniform data.
+            if (column.count("workload")) {
+                record.workload = fields[column["workload"]];
+            }
+            if (column.count("element_bytes")) {
+                record.elementBytes = std::stoull(fields[column["element_bytes"]]);
+            }
+
+            for (size_t e = 0; e < perf::EVENT_COUNT; ++e) {
+                const auto event = static_cast<perf::Event>(e);
+                if (const auto it = column.find(counterColumn(event)); it != column.end() && !fields[it->second].empty()) {
+                    record.counterRates[perf::eventName(event)] = std::stod(fields[it->second]);
+                }
+            }
+
+            std::istringstream samples(fields[column["samples_ms"]]);
+            std::string sample;
+            while (std::getline(samples, sample, ';')) {
+                if (!sample.empty()) record.samples.push_back(std::stod(sample));
+            }
+            records.push_back(std::move(record));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + " has a malformed number");
+        }
+    }
+    return records;
+}
+
+size_t compareBenchmarkResults(const std::string& basePath, const std::string& candidatePath,
+                               std::ostream& os, const double alpha, const double minChange) {
+    const auto base = readBenchmarkCsv(basePath);
+    const auto candidate = readBenchmarkCsv(candidatePath);
+
+    std::map<RecordKey, stats::Summary> baseSummaries;
+    for (const auto& record : base) {
+        baseSummaries[keyOf(record)] = stats::summarize(record.samples);
+    }
+
+    size_t nameWidth = std::string("Test Name").size();
+    for (const auto& record : candidate) {
+        nameWidth = std::max(nameWidth, record.testName.size());
+    }
+
+    os << "Comparing " << candidatePath << " against " << basePath
+       << " (alpha " << alpha << ", min change " << minChange * 100.0 << "%)\n";
+    os << std::left << std::setw(static_cast<int>(nameWidth)) << "Test Name"
+       << std::right << std::setw(9) << "Threads" << std::setw(10) << "Bins" << std::setw(14) << "Elements"
+       << std::setw(12) << "Workload" << std::setw(14) << "Base (ms)" << std::setw(14) << "New (ms)" << std::setw(11) << "Change"
+       << std::setw(11) << "p-value" << "  Verdict\n";
+
+    size_t regressions = 0, improvements = 0, unmatched = 0;
+    for (const auto& record : candidate) {
+        const auto it = baseSummaries.find(keyOf(record));
+        if (it == baseSummaries.end()) {
+            ++unmatched;
+            continue;
+        }
+
+        const stats::Summary& before = it->second;
+        const stats::Summary after = stats::summarize(record.samples);
+        const stats::WelchResult test = stats::welchTTest(before, after);
+        const double change = before.mean > 0.0 ? (after.mean - before.mean) / before.mean : 0.0;
+        const bool significant = test.pValue < alpha && std::abs(change) >= minChange;
+
+        std::string verdict;
+        if (significant && change > 0.0) {
+            verdict = "REGRESSION";
+            ++regressions;
+        } else if (significant) {
+            verdict = "improved";
+            ++improvements;
+        }
+
+        std::ostringstream changeText;
+        changeText << std::showpos << std::fixed << std::setprecision(1) << change * 100.0 << "%";
+
+        os << std::left << std::setw(static_cast<int>(nameWidth)) << record.testName << std::right
+           << std::setw(9) << record.threadCount << std::setw(10) << record.binSize << std::setw(14) << record.dataSize
+           << std::setw(12) << record.workload << std::fixed << std::setprecision(3)
+           << std::setw(14) << before.mean << std::setw(14) << after.mean
+           << std::setw(11) << changeText.str()
+           << std::setprecision(4) << std::setw(11) << test.pValue
+           << "  " << verdict << "\n";
+        os.unsetf(std::ios::fixed);
+    }
+
+    os << regressions << " regression(s), " << improvements << " improvement(s)";
+    if (unmatched) {
+        os << ", " << unmatched << " row(s) with no match in " << basePath;
+    }
+    os << "\n";
+    return regressions;
+}
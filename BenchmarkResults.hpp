@@ -0,0 +1,49 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_BENCHMARKRESULTS_HPP
+#define CUDAHISTOGRAMS_BENCHMARKRESULTS_HPP
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// p-value below which a difference counts as significant.
+constexpr double COMPARE_ALPHA = 0.05;
+// smallest relative change in mean time worth flagging, below it a "significant" change is just noise on a quiet box.
+constexpr double COMPARE_MIN_CHANGE = 0.02;
+
+struct BenchmarkRecord {
+    std::string testName;
+    size_t threadCount = 0;
+    size_t binSize = 0;
+    size_t dataSize = 0;
+    std::string workload = "uniform"; // input distribution
+    size_t elementBytes = sizeof(int);
+    std::vector<double> samples; // ms, in iteration order
+    std::map<std::string, double> counterRates; // perf event name -> count per element, captured events only
+};
+
+// snapshot of everything in the timing maps.
+std::vector<BenchmarkRecord> collectBenchmarkRecords();
+
+// one row per (test, threads, bins, elements, workload) with the summary columns, a <event>_per_element column per
+// perf event (empty when not captured) and the raw samples.
+void writeBenchmarkCsv(std::ostream& os, const std::string& gitHash, const std::vector<BenchmarkRecord>& records);
+void writeBenchmarkJson(std::ostream& os, const std::string& gitHash, const std::vector<BenchmarkRecord>& records);
+
+// writes <basePath>.csv and <basePath>.json, returns false if either could not be opened.
+bool writeBenchmarkResults(const std::string& basePath, const std::string& gitHash);
+
+// reads a file written by writeBenchmarkCsv, throws std::runtime_error if it cannot be parsed.
+std::vector<BenchmarkRecord> readBenchmarkCsv(const std::string& path);
+
+// Welch's t-test per matching row of two result files, prints every row and flags significant regressions.
+// Returns the number of regressions so the caller can use it as an exit code.
+size_t compareBenchmarkResults(const std::string& basePath, const std::string& candidatePath,
+                               std::ostream& os = std::cout,
+                               double alpha = COMPARE_ALPHA, double minChange = COMPARE_MIN_CHANGE);
+
+#endif //CUDAHISTOGRAMS_BENCHMARKRESULTS_HPP
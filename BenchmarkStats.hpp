@@ -0,0 +1,134 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_BENCHMARKSTATS_HPP
+#define CUDAHISTOGRAMS_BENCHMARKSTATS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace stats {
+
+    struct Summary {
+        size_t count = 0;
+        double first = 0.0;   // the first timed iteration, shows what is left of the warmup effect
+        double min = 0.0;
+        double median = 0.0;
+        double mean = 0.0;
+        double p95 = 0.0;
+        double stddev = 0.0;  // sample standard deviation
+        double total = 0.0;
+    };
+
+    // linear interpolation between the closest ranks of an already sorted sample.
+    inline double percentile(const std::vector<double>& sorted, const double p) {
+        if (sorted.empty()) return 0.0;
+        const double rank = p * static_cast<double>(sorted.size() - 1);
+        const size_t lo = static_cast<size_t>(rank);
+        const size_t hi = std::min(lo + 1, sorted.size() - 1);
+        return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - static_cast<double>(lo));
+    }
+
+    inline Summary summarize(const std::vector<double>& samples) {
+        Summary s;
+        if (samples.empty()) return s;
+
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        s.count  = samples.size();
+        s.first  = samples.front();
+        s.min    = sorted.front();
+        s.median = percentile(sorted, 0.5);
+        s.p95    = percentile(sorted, 0.95);
+        s.total  = std::accumulate(samples.begin(), samples.end(), 0.0);
+        s.mean   = s.total / static_cast<double>(s.count);
+
+        double squares = 0.0;
+        for (const double x : samples) {
+            squares += (x - s.mean) * (x - s.mean);
+        }
+        s.stddev = s.count > 1 ? std::sqrt(squares / static_cast<double>(s.count - 1)) : 0.0;
+        return s;
+    }
+
+    // a counter total over every timed iteration as a per input element rate.
+    inline double perElement(const double total, const size_t iterations, const size_t dataSize) {
+        const double elements = static_cast<double>(iterations) * static_cast<double>(dataSize);
+        return elements > 0.0 ? total / elements : 0.0;
+    }
+
+    // continued fraction of the regularized incomplete beta function (Numerical Recipes, betacf).
+    inline double betaContinuedFraction(const double a, const double b, const double x) {
+        constexpr int maxIterations = 200;
+        constexpr double eps = 3e-14;
+        constexpr double tiny = 1e-300;
+
+        const double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+        double c = 1.0;
+        double d = 1.0 - qab * x / qap;
+        if (std::fabs(d) < tiny) d = tiny;
+        d = 1.0 / d;
+        double h = d;
+        for (int m = 1; m <= maxIterations; ++m) {
+            const int m2 = 2 * m;
+            double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+            d = 1.0 + aa * d;
+            if (std::fabs(d) < tiny) d = tiny;
+            c = 1.0 + aa / c;
+            if (std::fabs(c) < tiny) c = tiny;
+            d = 1.0 / d;
+            h *= d * c;
+            aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+            d = 1.0 + aa * d;
+            if (std::fabs(d) < tiny) d = tiny;
+            c = 1.0 + aa / c;
+            if (std::fabs(c) < tiny) c = tiny;
+            d = 1.0 / d;
+            const double delta = d * c;
+            h *= delta;
+            if (std::fabs(delta - 1.0) < eps) break;
+        }
+        return h;
+    }
+
+    inline double incompleteBeta(const double a, const double b, const double x) {
+        if (x <= 0.0) return 0.0;
+        if (x >= 1.0) return 1.0;
+        const double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log(1.0 - x));
+        if (x < (a + 1.0) / (a + b + 2.0)) {
+            return front * betaContinuedFraction(a, b, x) / a;
+        }
+        return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+    }
+
+    struct WelchResult {
+        double t = 0.0;
+        double degreesOfFreedom = 0.0;
+        double pValue = 1.0; // two sided
+    };
+
+    // Welch's unequal variance t-test between two sets of timings.
+    inline WelchResult welchTTest(const Summary& a, const Summary& b) {
+        WelchResult r;
+        if (a.count < 2 || b.count < 2) return r;
+
+        const double va = a.stddev * a.stddev / static_cast<double>(a.count);
+        const double vb = b.stddev * b.stddev / static_cast<double>(b.count);
+        if (va + vb == 0.0) {
+            r.pValue = a.mean == b.mean ? 1.0 : 0.0;
+            return r;
+        }
+
+        r.t = (b.mean - a.mean) / std::sqrt(va + vb);
+        r.degreesOfFreedom = (va + vb) * (va + vb) /
+            (va * va / static_cast<double>(a.count - 1) + vb * vb / static_cast<double>(b.count - 1));
+        r.pValue = incompleteBeta(r.degreesOfFreedom / 2.0, 0.5, r.degreesOfFreedom / (r.degreesOfFreedom + r.t * r.t));
+        return r;
+    }
+}
+
+#endif //CUDAHISTOGRAMS_BENCHMARKSTATS_HPP
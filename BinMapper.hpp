@@ -0,0 +1,201 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_BINMAPPER_HPP
+#define CUDAHISTOGRAMS_BINMAPPER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Bin mappers turn one input value into a histogram index. They are small value types the solvers take by
+// template parameter, so the call inlines into the count loop. Every operator() is branch free (selects
+// only), and mapBlock() maps a block of values in loops the compiler vectorizes.
+//
+// Out of range values are either clamped into the first/last bin or counted in two extra bins right after
+// the regular ones: bins() is underflow, bins() + 1 is overflow. NaN counts as underflow (or clamps to 0).
+enum class OutOfRange {
+    Clamp,
+    Count
+};
+
+// floats map in float, everything else in double so 32/64 bit values keep their precision.
+template<typename T>
+using MapperFloat = std::conditional_t<std::is_same_v<T, float>, float, double>;
+
+namespace detail {
+    template<OutOfRange Range>
+    constexpr size_t histogramSizeFor(const size_t bins) {
+        return bins + (Range == OutOfRange::Count ? 2 : 0);
+    }
+}
+
+// values already are bin numbers, like the int solvers assume.
+template<typename T, OutOfRange Range = OutOfRange::Clamp>
+class IdentityMapper {
+    static_assert(std::is_integral_v<T>);
+    uint32_t binCount;
+public:
+    using value_type = T;
+
+    explicit IdentityMapper(const size_t bins) : binCount(static_cast<uint32_t>(bins)) {
+        if (bins == 0) throw std::invalid_argument("IdentityMapper needs at least one bin");
+    }
+
+    size_t bins() const { return binCount; }
+    size_t histogramSize() const { return detail::histogramSizeFor<Range>(binCount); }
+
+    uint32_t operator()(const T value) const {
+        const int64_t x = static_cast<int64_t>(value);
+        if constexpr (Range == OutOfRange::Clamp) {
+            return static_cast<uint32_t>(std::clamp<int64_t>(x, 0, binCount - 1));
+        } else {
+            const uint32_t inRange = static_cast<uint32_t>(x);
+            const uint32_t outOfRange = x < 0 ? binCount : binCount + 1;
+            return x >= 0 && x < binCount ? inRange : outOfRange;
+        }
+    }
+
+    void mapBlock(const T* values, const size_t count, uint32_t* indices) const {
+        for (size_t i = 0; i < count; ++i) {
+            indices[i] = (*this)(values[i]);
+        }
+    }
+};
+
+// bins equal width bins over [lo, hi). The divide by the bin width is precomputed into one multiply.
+template<typename T, OutOfRange Range = OutOfRange::Clamp>
+class UniformMapper {
+    using F = MapperFloat<T>;
+    F lo;
+    F hi;
+    F scale;
+    uint32_t binCount;
+public:
+    using value_type = T;
+
+    UniformMapper(const double lo, const double hi, const size_t bins)
+        : lo(static_cast<F>(lo)), hi(static_cast<F>(hi)), scale(static_cast<F>(static_cast<double>(bins) / (hi - lo))),
+          binCount(static_cast<uint32_t>(bins)) {
+        if (bins == 0 || !(hi > lo)) throw std::invalid_argument("UniformMapper needs bins > 0 and hi > lo");
+    }
+
+    size_t bins() const { return binCount; }
+    size_t histogramSize() const { return detail::histogramSizeFor<Range>(binCount); }
+
+    uint32_t operator()(const T value) const {
+        const F v = static_cast<F>(value);
+        const F last = static_cast<F>(binCount - 1);
+        F x = (v - lo) * scale;
+        x = x >= F(0) ? x : F(0); // NaN lands here too
+        // rounding in the multiply can push a value just below hi onto binCount.
+        x = x < last ? x : last;
+        if constexpr (Range == OutOfRange::Clamp) {
+            return static_cast<uint32_t>(x);
+        } else {
+            const uint32_t inRange = static_cast<uint32_t>(x);
+            const uint32_t outOfRange = v >= hi ? binCount + 1 : binCount;
+            return v >= lo && v < hi ? inRange : outOfRange;
+        }
+    }
+
+    void mapBlock(const T* values, const size_t count, uint32_t* indices) const {
+        for (size_t i = 0; i < count; ++i) {
+            indices[i] = (*this)(values[i]);
+        }
+    }
+};
+
+// arbitrary sorted edges, bin i is [edges[i], edges[i + 1]). Looked up with a fixed trip count binary search
+// over the edges padded to a power of two, or for 8/16 bit inputs through a table of every possible value.
+template<typename T, OutOfRange Range = OutOfRange::Clamp>
+class EdgesMapper {
+    using F = MapperFloat<T>;
+    static constexpr bool USE_TABLE = std::is_integral_v<T> && sizeof(T) <= 2;
+
+    std::vector<F> search;      // edges, then +inf up to a power of two
+    std::vector<uint32_t> table;
+    uint32_t binCount;
+
+    // pos is the last edge <= v, or 0 if v is below every edge.
+    uint32_t binOf(const F v, const size_t pos) const {
+        const uint32_t last = binCount - 1;
+        const uint32_t inRange = static_cast<uint32_t>(pos);
+        if constexpr (Range == OutOfRange::Clamp) {
+            return pos < last ? inRange : last;
+        } else {
+            const bool under = !(v >= search[0]);
+            const bool over = !under && pos >= binCount;
+            return under ? binCount : over ? binCount + 1 : inRange;
+        }
+    }
+
+    uint32_t lookup(const F v) const {
+        const size_t n = search.size();
+        size_t pos = 0;
+        for (size_t step = n / 2; step > 0; step /= 2) {
+            pos += v >= search[pos + step] ? step : 0;
+        }
+        return binOf(v, pos);
+    }
+
+public:
+    using value_type = T;
+
+    explicit EdgesMapper(const std::vector<double>& edges) : binCount(static_cast<uint32_t>(edges.size() - 1)) {
+        if (edges.size() < 2 || !std::is_sorted(edges.begin(), edges.end())) {
+            throw std::invalid_argument("EdgesMapper needs at least two sorted edges");
+        }
+        size_t padded = 1;
+        while (padded < edges.size()) padded *= 2;
+        search.assign(padded, std::numeric_limits<F>::infinity());
+        std::transform(edges.begin(), edges.end(), search.begin(), [](const double e) { return static_cast<F>(e); });
+
+        if constexpr (USE_TABLE) {
+            constexpr int64_t lowest = std::numeric_limits<T>::min();
+            constexpr int64_t highest = std::numeric_limits<T>::max();
+            table.resize(static_cast<size_t>(highest - lowest + 1));
+            for (int64_t v = lowest; v <= highest; ++v) {
+                table[static_cast<size_t>(v - lowest)] = lookup(static_cast<F>(v));
+            }
+        }
+    }
+
+    size_t bins() const { return binCount; }
+    size_t histogramSize() const { return detail::histogramSizeFor<Range>(binCount); }
+
+    uint32_t operator()(const T value) const {
+        if constexpr (USE_TABLE) {
+            return table[static_cast<size_t>(static_cast<int64_t>(value) - std::numeric_limits<T>::min())];
+        } else {
+            return lookup(static_cast<F>(value));
+        }
+    }
+
+    // the search runs one step at a time across the whole block: the step loop's trip count depends on the
+    // edges, so with it innermost nothing vectorizes, outermost every step is one gather/compare/add loop.
+    void mapBlock(const T* values, const size_t count, uint32_t* indices) const {
+        if constexpr (USE_TABLE) {
+            for (size_t i = 0; i < count; ++i) {
+                indices[i] = (*this)(values[i]);
+            }
+        } else {
+            const F* edges = search.data();
+            std::fill_n(indices, count, 0u);
+            for (uint32_t step = static_cast<uint32_t>(search.size() / 2); step > 0; step /= 2) {
+                for (size_t i = 0; i < count; ++i) {
+                    indices[i] += static_cast<F>(values[i]) >= edges[indices[i] + step] ? step : 0;
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                indices[i] = binOf(static_cast<F>(values[i]), indices[i]);
+            }
+        }
+    }
+};
+
+#endif //CUDAHISTOGRAMS_BINMAPPER_HPP
@@ -0,0 +1,85 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_BINNEDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_BINNEDHISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "BinMapper.hpp"
+#include "Common.hpp"
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+// values mapped per block before counting: the mapping loop has no stores into the histogram, so it
+// vectorizes, and the block of indices stays in L1 for the increment loop.
+constexpr size_t BIN_MAP_BLOCK = 256;
+
+template<typename T, typename Mapper>
+void countBinned(const T* data, const size_t count, int* histogram, const Mapper& mapper) {
+    static_assert(std::is_same_v<typename Mapper::value_type, T>);
+    alignas(64) uint32_t indices[BIN_MAP_BLOCK];
+    for (size_t base = 0; base < count; base += BIN_MAP_BLOCK) {
+        const size_t n = std::min(BIN_MAP_BLOCK, count - base);
+        mapper.mapBlock(data + base, n, indices);
+        for (size_t i = 0; i < n; ++i) {
+            ++histogram[indices[i]];
+        }
+    }
+}
+
+// single threaded truth for the binned solvers. histogram holds mapper.histogramSize() bins.
+template<typename T, typename Mapper, typename U>
+void solveBinnedNaiveHistogram(const T* data, const U& histogram, const size_t size, const Mapper& mapper) {
+    for (size_t i = 0; i < size; ++i) {
+        ++histogram[mapper(data[i])];
+    }
+}
+
+// the bin sliced reduced engine on any element type. privateHistograms holds threadAmount page padded
+// histograms of perThreadInts and must be zero on entry, the reduction leaves it zeroed again.
+template<typename T, typename Mapper, typename Pool = ThreadPool>
+void solveThreadedBinnedHistogram(const std::shared_ptr<T[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    const size_t dataSize, const Mapper& mapper, const size_t threadAmount, const size_t perThreadInts, Pool& pool) {
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &data, &privateHistograms, &mapper](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        countBinned(data.get() + start, end - start, privateHistograms.get() + t * perThreadInts, mapper);
+    }).wait();
+
+    reduceBinSliced<true>(privateHistograms.get(), perThreadInts, threadAmount, histogram, mapper.histogramSize(), threadAmount, pool);
+}
+
+// timings are keyed by mapper.histogramSize() bins.
+template<typename T, typename Mapper, typename Pool = ThreadPool>
+void profile_threaded_binned_cpu_histogram(const std::shared_ptr<T[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           const size_t dataSize, const Mapper& mapper, const size_t threadAmount, const std::string &testName, const size_t iterations, Pool& pool) {
+    const size_t bins = mapper.histogramSize();
+    const size_t perThreadInts = reducedPerThreadBytesPaged(bins, systemPageSize()) / sizeof(int);
+    const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+
+    // warmup
+    solveThreadedBinnedHistogram(data, testHistogram, privateHistograms, dataSize, mapper, threadAmount, perThreadInts, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), bins); // clear last test if any.
+        TIMING_BEGIN(testName, bins, dataSize, threadAmount);
+        solveThreadedBinnedHistogram(data, testHistogram, privateHistograms, dataSize, mapper, threadAmount, perThreadInts, pool);
+        TIMING_END(testName, bins, dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, bins);
+    }
+    std::lock_guard<std::mutex> lock(timing::mutex());
+    timing::elementBytes()[{testName, bins, dataSize, threadAmount}] = sizeof(T);
+}
+
+#endif //CUDAHISTOGRAMS_BINNEDHISTOGRAM_HPP
@@ -2,9 +2,45 @@
 // Created by Steven Roddan on 2/9/2026.
 //
 
+#include <cstdlib>
 #include <cstring>
 #include "Common.hpp"
 
+#if defined(_WIN32)
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 void clear(int* arr, const size_t size) {
     std::memset(arr, 0, size * sizeof(int));
 }
+
+
+size_t systemPageSize() {
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+void* alignedAlloc(const size_t bytes, const size_t alignment) {
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    return std::aligned_alloc(alignment, (bytes + alignment - 1) & ~(alignment - 1));
+#endif
+}
+
+void alignedFree(void* ptr) {
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
\ No newline at end of file
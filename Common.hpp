@@ -6,6 +6,7 @@
 #define CUDAHISTOGRAMS_UTIL_HPP
 
 #include <iostream>
+#include <memory>
 
 #define CPU_THREADS 16
 
@@ -28,4 +29,19 @@ void validate(const T& truth, const U& test, const size_t size) {
 
 void clear(int* arr, size_t size);
 
+inline bool isPowerOfTwo(const size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+size_t systemPageSize();
+
+// page/cache-line aligned buffers for the per-thread histograms, release with alignedFree.
+void* alignedAlloc(size_t bytes, size_t alignment);
+void alignedFree(void* ptr);
+
+template<typename T>
+std::shared_ptr<T[]> makeAlignedArray(const size_t count, const size_t alignment) {
+    return std::shared_ptr<T[]>(static_cast<T*>(alignedAlloc(count * sizeof(T), alignment)), [](T* p) { alignedFree(p); });
+}
+
 #endif //CUDAHISTOGRAMS_UTIL_HPP
\ No newline at end of file
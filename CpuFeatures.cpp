@@ -0,0 +1,74 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "CpuFeatures.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <cstdint>
+
+namespace {
+    struct CpuidRegisters {
+        uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+    };
+
+    CpuidRegisters cpuid(const uint32_t leaf, const uint32_t subLeaf) {
+        CpuidRegisters r;
+#if defined(_MSC_VER)
+        int regs[4];
+        __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subLeaf));
+        r.eax = regs[0]; r.ebx = regs[1]; r.ecx = regs[2]; r.edx = regs[3];
+#else
+        __cpuid_count(leaf, subLeaf, r.eax, r.ebx, r.ecx, r.edx);
+#endif
+        return r;
+    }
+
+    uint64_t xgetbv0() {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+    }
+
+    SimdLevel querySimdLevel() {
+        if (cpuid(0, 0).eax < 7) return SimdLevel::Scalar;
+
+        const CpuidRegisters leaf1 = cpuid(1, 0);
+        const bool osxsave = (leaf1.ecx & (1u << 27)) != 0;
+        if (!osxsave) return SimdLevel::Scalar;
+
+        const uint64_t xcr0 = xgetbv0();
+        const bool ymmEnabled = (xcr0 & 0x6) == 0x6;     // SSE + AVX state
+        const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;   // + opmask, ZMM_Hi256, Hi16_ZMM
+
+        const CpuidRegisters leaf7 = cpuid(7, 0);
+        const bool avx2     = (leaf7.ebx & (1u << 5)) != 0;
+        const bool avx512f  = (leaf7.ebx & (1u << 16)) != 0;
+        const bool avx512cd = (leaf7.ebx & (1u << 28)) != 0;
+
+        if (avx512f && avx512cd && zmmEnabled) return SimdLevel::AVX512;
+        if (avx2 && ymmEnabled) return SimdLevel::AVX2;
+        return SimdLevel::Scalar;
+    }
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = querySimdLevel();
+    return level;
+}
+
+const char* simdLevelName(const SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512: return "AVX-512";
+        case SimdLevel::AVX2:   return "AVX2";
+        default:                return "Scalar";
+    }
+}
@@ -0,0 +1,29 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_CPUFEATURES_HPP
+#define CUDAHISTOGRAMS_CPUFEATURES_HPP
+
+// MSVC builds the whole library with /arch:AVX512, gcc/clang need the ISA enabled per function
+// so the dispatched kernels can live next to the scalar fallback in the same translation unit.
+#if defined(_MSC_VER)
+#define HISTOGRAM_TARGET_AVX2
+#define HISTOGRAM_TARGET_AVX512
+#else
+#define HISTOGRAM_TARGET_AVX2 __attribute__((target("avx2")))
+#define HISTOGRAM_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512cd")))
+#endif
+
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// queried once through CPUID/XGETBV, checks both the ISA and that the OS saves the wider registers.
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+#endif //CUDAHISTOGRAMS_CPUFEATURES_HPP
@@ -0,0 +1,186 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_FUSEDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_FUSEDHISTOGRAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BinnedHistogram.hpp"
+#include "Common.hpp"
+#include "MachineInfo.hpp"
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+// Several histograms of the same input from one scan, e.g. 512, 4096 and 131072 bins of one column. Every
+// block of BIN_MAP_BLOCK values is loaded once and mapped/counted by each mapper while it sits in L1.
+//
+// The smallest configurations get per thread private histograms, back to back in one page padded block per
+// thread, as long as that block fits privateBudgetBytes (half of L2 by default). They are reduced together by
+// one bin sliced pass over the whole block. Whatever does not fit is counted into one shared histogram with
+// relaxed atomic adds: large bin counts rarely collide, and a private copy per thread would not stay cached.
+template<typename Mapper>
+class FusedHistograms {
+    std::vector<Mapper> mappers;
+    std::vector<char> shared;         // per mapper
+    std::vector<size_t> offsets;      // per private mapper, into a thread's block and into combined
+    size_t privateInts = 0;           // bins of all private configurations
+    size_t perThreadInts = 0;
+    size_t threadAmount;
+    std::shared_ptr<int[]> privateHistograms; // threadAmount * perThreadInts, zero between solves
+    std::shared_ptr<int[]> combined;          // the reduced private configurations, back to back
+    std::vector<std::shared_ptr<int[]>> sharedHistograms; // null for private configurations
+
+public:
+    FusedHistograms(std::vector<Mapper> mapperList, const size_t threadAmount, const size_t privateBudgetBytes = machineInfo().l2Bytes / 2)
+        : mappers(std::move(mapperList)), shared(mappers.size(), 1), offsets(mappers.size(), 0), threadAmount(threadAmount),
+          sharedHistograms(mappers.size()) {
+        if (mappers.empty()) throw std::invalid_argument("FusedHistograms needs at least one mapper");
+
+        // smallest first, so as many configurations as possible stay private.
+        std::vector<size_t> order(mappers.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](const size_t a, const size_t b) {
+            return mappers[a].histogramSize() < mappers[b].histogramSize();
+        });
+        for (const size_t m : order) {
+            if ((privateInts + mappers[m].histogramSize()) * sizeof(int) > privateBudgetBytes) break;
+            shared[m] = 0;
+            offsets[m] = privateInts;
+            privateInts += mappers[m].histogramSize();
+        }
+
+        perThreadInts = reducedPerThreadBytesPaged(std::max<size_t>(privateInts, 1), systemPageSize()) / sizeof(int);
+        privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+        clear(privateHistograms.get(), perThreadInts * threadAmount);
+        combined = std::shared_ptr<int[]>(new int[std::max<size_t>(privateInts, 1)]);
+        for (size_t m = 0; m < mappers.size(); ++m) {
+            if (shared[m]) sharedHistograms[m] = makeAlignedArray<int>(mappers[m].histogramSize(), std::hardware_destructive_interference_size);
+        }
+    }
+
+    size_t size() const { return mappers.size(); }
+    const Mapper& mapper(const size_t m) const { return mappers[m]; }
+    bool isShared(const size_t m) const { return shared[m] != 0; }
+    // mapper(m).histogramSize() bins, valid until the next solve.
+    const int* histogram(const size_t m) const { return shared[m] ? sharedHistograms[m].get() : combined.get() + offsets[m]; }
+
+    // every histogram is overwritten.
+    template<typename T, typename Pool = ThreadPool>
+    void solve(const T* data, const size_t dataSize, Pool& pool) {
+        static_assert(std::is_same_v<typename Mapper::value_type, T>);
+        for (size_t m = 0; m < mappers.size(); ++m) {
+            if (shared[m]) clear(sharedHistograms[m].get(), mappers[m].histogramSize());
+        }
+
+        const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+        pool.parallel_for(0, threadAmount, 1, [=, this](const size_t t) {
+            trace::Scope scope(trace::Phase::Count);
+            int* block = privateHistograms.get() + t * perThreadInts;
+            const size_t start = std::min(t * elementsPerThread, dataSize);
+            const size_t end   = std::min(start + elementsPerThread, dataSize);
+            alignas(64) uint32_t indices[BIN_MAP_BLOCK];
+
+            for (size_t base = start; base < end; base += BIN_MAP_BLOCK) {
+                const size_t n = std::min(BIN_MAP_BLOCK, end - base);
+                for (size_t m = 0; m < mappers.size(); ++m) {
+                    const Mapper& mapper = mappers[m];
+                    mapper.mapBlock(data + base, n, indices);
+                    if (!shared[m]) {
+                        int* hist = block + offsets[m];
+                        for (size_t i = 0; i < n; ++i) {
+                            ++hist[indices[i]];
+                        }
+                    } else {
+                        int* hist = sharedHistograms[m].get();
+                        for (size_t i = 0; i < n; ++i) {
+                            std::atomic_ref<int>(hist[indices[i]]).fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+        }).wait();
+
+        if (privateInts > 0) {
+            reduceBinSliced<true>(privateHistograms.get(), perThreadInts, threadAmount, combined.get(), privateInts, threadAmount, pool);
+        }
+    }
+};
+
+// timings are keyed by the bins of all configurations together.
+template<typename Mapper>
+size_t totalHistogramSize(const std::vector<Mapper>& mappers) {
+    size_t bins = 0;
+    for (const Mapper& mapper : mappers) {
+        bins += mapper.histogramSize();
+    }
+    return bins;
+}
+
+template<typename T, typename Mapper>
+void profile_fused_cpu_histograms(const std::shared_ptr<T[]> &data, const std::vector<std::shared_ptr<int[]>> &truthHistograms, const size_t dataSize,
+                                  const std::vector<Mapper>& mappers, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool,
+                                  const size_t privateBudgetBytes = machineInfo().l2Bytes / 2) {
+    const size_t bins = totalHistogramSize(mappers);
+    FusedHistograms<Mapper> fused(mappers, threadAmount, privateBudgetBytes);
+
+    // warmup
+    fused.solve(data.get(), dataSize, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        TIMING_BEGIN(testName, bins, dataSize, threadAmount);
+        fused.solve(data.get(), dataSize, pool);
+        TIMING_END(testName, bins, dataSize, threadAmount);
+        for (size_t m = 0; m < mappers.size(); ++m) {
+            validate(truthHistograms[m], fused.histogram(m), mappers[m].histogramSize());
+        }
+    }
+    std::lock_guard<std::mutex> lock(timing::mutex());
+    timing::elementBytes()[{testName, bins, dataSize, threadAmount}] = sizeof(T);
+}
+
+// the same configurations one binned solve (one scan) each, for comparison.
+template<typename T, typename Mapper>
+void profile_separate_cpu_histograms(const std::shared_ptr<T[]> &data, const std::vector<std::shared_ptr<int[]>> &truthHistograms, const size_t dataSize,
+                                     const std::vector<Mapper>& mappers, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const size_t bins = totalHistogramSize(mappers);
+    size_t perThreadInts = 0;
+    std::vector<std::shared_ptr<int[]>> testHistograms;
+    for (const Mapper& mapper : mappers) {
+        perThreadInts = std::max(perThreadInts, reducedPerThreadBytesPaged(mapper.histogramSize(), systemPageSize()) / sizeof(int));
+        testHistograms.emplace_back(new int[mapper.histogramSize()]);
+    }
+    const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+
+    const auto run = [&]() {
+        for (size_t m = 0; m < mappers.size(); ++m) {
+            solveThreadedBinnedHistogram(data, testHistograms[m], privateHistograms, dataSize, mappers[m], threadAmount, perThreadInts, pool);
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        TIMING_BEGIN(testName, bins, dataSize, threadAmount);
+        run();
+        TIMING_END(testName, bins, dataSize, threadAmount);
+        for (size_t m = 0; m < mappers.size(); ++m) {
+            validate(truthHistograms[m], testHistograms[m], mappers[m].histogramSize());
+        }
+    }
+    std::lock_guard<std::mutex> lock(timing::mutex());
+    timing::elementBytes()[{testName, bins, dataSize, threadAmount}] = sizeof(T);
+}
+
+#endif //CUDAHISTOGRAMS_FUSEDHISTOGRAM_HPP
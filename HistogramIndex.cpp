@@ -0,0 +1,280 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "HistogramIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+#include <random>
+#include <stdexcept>
+
+#include "Common.hpp"
+#include "Timer.hpp"
+
+namespace {
+    int64_t scanScalar(const int* counts, const size_t n, int64_t* out) {
+        int64_t running = 0;
+        for (size_t i = 0; i < n; ++i) {
+            running += counts[i];
+            out[i] = running;
+        }
+        return running;
+    }
+
+    // 8 counts widened to int64, scanned in register with three shift-and-add steps (valignq shifts in
+    // zeros), then offset by the last sum of the previous vector.
+    HISTOGRAM_TARGET_AVX512
+    int64_t scanAvx512(const int* counts, const size_t n, int64_t* out) {
+        const __m512i zero = _mm512_setzero_si512();
+        const __m512i lastLane = _mm512_set1_epi64(7);
+        __m512i carry = zero;
+
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m512i x = _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + i)));
+            x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 7));
+            x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 6));
+            x = _mm512_add_epi64(x, _mm512_alignr_epi64(x, zero, 4));
+            x = _mm512_add_epi64(x, carry);
+            _mm512_storeu_si512(out + i, x);
+            carry = _mm512_permutexvar_epi64(lastLane, x);
+        }
+
+        int64_t running = _mm_cvtsi128_si64(_mm512_castsi512_si128(carry));
+        for (; i < n; ++i) {
+            running += counts[i];
+            out[i] = running;
+        }
+        return running;
+    }
+}
+
+HistogramIndex::HistogramIndex(const SimdLevel level) : blockBase{0}, level(level) {
+}
+
+int64_t HistogramIndex::scanBlock(const int* histogram, const size_t k) {
+    const size_t begin = k * HISTOGRAM_INDEX_BLOCK;
+    const size_t n = std::min(HISTOGRAM_INDEX_BLOCK, binCount - begin);
+    if (level == SimdLevel::AVX512) {
+        return scanAvx512(histogram + begin, n, inclusive.data() + begin);
+    }
+    return scanScalar(histogram + begin, n, inclusive.data() + begin);
+}
+
+void HistogramIndex::build(const int* histogram, const size_t bins) {
+    binCount = bins;
+    inclusive.resize(bins);
+    blockBase.assign((bins + HISTOGRAM_INDEX_BLOCK - 1) / HISTOGRAM_INDEX_BLOCK + 1, 0);
+    for (size_t k = 0; k < blocks(); ++k) {
+        blockBase[k + 1] = blockBase[k] + scanBlock(histogram, k);
+    }
+}
+
+void HistogramIndex::build(const int* histogram, const size_t bins, ThreadPool& pool) {
+    binCount = bins;
+    inclusive.resize(bins);
+    blockBase.assign((bins + HISTOGRAM_INDEX_BLOCK - 1) / HISTOGRAM_INDEX_BLOCK + 1, 0);
+
+    // block totals land one slot to the right, the serial pass turns them into running totals in place.
+    const size_t blocksPerTask = (blocks() + pool.size() - 1) / pool.size();
+    pool.parallel_for(0, blocks(), blocksPerTask, [this, histogram](const size_t begin, const size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            blockBase[k + 1] = scanBlock(histogram, k);
+        }
+    }).wait();
+
+    for (size_t k = 0; k < blocks(); ++k) {
+        blockBase[k + 1] += blockBase[k];
+    }
+}
+
+void HistogramIndex::update(const int* histogram, const std::span<const size_t> changedBins) {
+    if (changedBins.empty()) return;
+    std::vector<size_t> changedBlocks;
+    changedBlocks.reserve(changedBins.size());
+    for (const size_t bin : changedBins) {
+        if (bin >= binCount) throw std::out_of_range("changed bin outside the indexed histogram");
+        changedBlocks.push_back(bin / HISTOGRAM_INDEX_BLOCK);
+    }
+    std::sort(changedBlocks.begin(), changedBlocks.end());
+    changedBlocks.erase(std::unique(changedBlocks.begin(), changedBlocks.end()), changedBlocks.end());
+
+    // new totals of the changed blocks, the unchanged ones still have theirs as blockBase differences.
+    std::vector<int64_t> totals(changedBlocks.size());
+    for (size_t c = 0; c < changedBlocks.size(); ++c) {
+        totals[c] = scanBlock(histogram, changedBlocks[c]);
+    }
+
+    int64_t running = blockBase[changedBlocks.front()];
+    size_t next = 0;
+    for (size_t k = changedBlocks.front(); k < blocks(); ++k) {
+        const int64_t blockTotal = next < changedBlocks.size() && changedBlocks[next] == k ? totals[next++] : blockBase[k + 1] - blockBase[k];
+        blockBase[k] = running;
+        running += blockTotal;
+    }
+    blockBase.back() = running;
+}
+
+double HistogramIndex::cdf(const size_t bin) const {
+    const int64_t all = total();
+    return all == 0 ? 0.0 : static_cast<double>(prefix(std::min(bin + 1, binCount))) / static_cast<double>(all);
+}
+
+size_t HistogramIndex::binOfRank(const int64_t rank) const {
+    // first block whose running total reaches rank, then the first bin inside it.
+    const auto blockEnd = std::lower_bound(blockBase.begin() + 1, blockBase.end(), rank);
+    const size_t k = static_cast<size_t>(blockEnd - blockBase.begin()) - 1;
+    const size_t begin = k * HISTOGRAM_INDEX_BLOCK;
+    const size_t end = std::min(begin + HISTOGRAM_INDEX_BLOCK, binCount);
+    const auto bin = std::lower_bound(inclusive.begin() + begin, inclusive.begin() + end, rank - blockBase[k]);
+    return static_cast<size_t>(bin - inclusive.begin());
+}
+
+size_t HistogramIndex::quantile(const double q) const {
+    const int64_t all = total();
+    if (all == 0) throw std::domain_error("quantile of an empty histogram");
+    const auto rank = static_cast<int64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(all)));
+    return binOfRank(std::clamp<int64_t>(rank, 1, all));
+}
+
+size_t linearScanQuantile(const int* histogram, const size_t bins, const double q) {
+    int64_t all = 0;
+    for (size_t b = 0; b < bins; ++b) {
+        all += histogram[b];
+    }
+    if (all == 0) throw std::domain_error("quantile of an empty histogram");
+    const int64_t rank = std::clamp<int64_t>(static_cast<int64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(all))), 1, all);
+    int64_t running = 0;
+    for (size_t b = 0; b < bins; ++b) {
+        running += histogram[b];
+        if (running >= rank) return b;
+    }
+    return bins - 1;
+}
+
+int64_t linearScanRangeCount(const int* histogram, const size_t begin, const size_t end) {
+    int64_t sum = 0;
+    for (size_t b = begin; b < end; ++b) {
+        sum += histogram[b];
+    }
+    return sum;
+}
+
+void profile_histogram_index_build(const std::shared_ptr<int[]> &histogram, const size_t maxVal, const size_t threadAmount, const std::string &testName,
+                                   const size_t iterations, ThreadPool& pool) {
+    HistogramIndex index;
+    const auto run = [&]() {
+        if (threadAmount == 1) {
+            index.build(histogram.get(), maxVal);
+        } else {
+            index.build(histogram.get(), maxVal, pool);
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        TIMING_BEGIN(testName, maxVal, maxVal, threadAmount);
+        run();
+        TIMING_END(testName, maxVal, maxVal, threadAmount);
+
+        int64_t running = 0;
+        for (size_t b = 0; b < maxVal; ++b) {
+            if (index.prefix(b) != running) {
+                std::cout << "Error at index " << b << " -> Truth: " << running << " vs " << index.prefix(b) << std::endl;
+                abort();
+            }
+            running += histogram[b];
+        }
+    }
+}
+
+void profile_histogram_index_queries(const std::shared_ptr<int[]> &histogram, const size_t maxVal, const size_t queryCount, const bool useIndex,
+                                     const std::string &testName, const size_t iterations) {
+    // the same queries every run: percentiles spread over (0, 1] and random ranges.
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> quantileDis(0.0, 1.0);
+    std::uniform_int_distribution<size_t> binDis(0, maxVal);
+    std::vector<double> quantiles(queryCount);
+    std::vector<std::pair<size_t, size_t>> ranges(queryCount);
+    for (size_t q = 0; q < queryCount; ++q) {
+        quantiles[q] = quantileDis(gen);
+        const size_t a = binDis(gen), b = binDis(gen);
+        ranges[q] = {std::min(a, b), std::max(a, b)};
+    }
+
+    std::vector<size_t> truthQuantiles(queryCount), testQuantiles(queryCount);
+    std::vector<int64_t> truthRanges(queryCount), testRanges(queryCount);
+    for (size_t q = 0; q < queryCount; ++q) {
+        truthQuantiles[q] = linearScanQuantile(histogram.get(), maxVal, quantiles[q]);
+        truthRanges[q] = linearScanRangeCount(histogram.get(), ranges[q].first, ranges[q].second);
+    }
+
+    HistogramIndex index;
+    index.build(histogram.get(), maxVal);
+
+    const auto run = [&]() {
+        for (size_t q = 0; q < queryCount; ++q) {
+            if (useIndex) {
+                testQuantiles[q] = index.quantile(quantiles[q]);
+                testRanges[q] = index.rangeCount(ranges[q].first, ranges[q].second);
+            } else {
+                testQuantiles[q] = linearScanQuantile(histogram.get(), maxVal, quantiles[q]);
+                testRanges[q] = linearScanRangeCount(histogram.get(), ranges[q].first, ranges[q].second);
+            }
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        TIMING_BEGIN(testName, maxVal, queryCount, 1);
+        run();
+        TIMING_END(testName, maxVal, queryCount, 1);
+        validate(truthQuantiles, testQuantiles, queryCount);
+        validate(truthRanges, testRanges, queryCount);
+    }
+}
+
+void profile_histogram_index_update(const std::shared_ptr<int[]> &histogram, const size_t maxVal, const size_t changedCount, const std::string &testName,
+                                    const size_t iterations) {
+    std::vector<int> merged(histogram.get(), histogram.get() + maxVal);
+    HistogramIndex index;
+    index.build(merged.data(), maxVal);
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<size_t> binDis(0, maxVal - 1);
+    std::uniform_int_distribution<int> deltaDis(0, 64);
+    std::vector<size_t> changed(changedCount);
+
+    const auto change = [&]() {
+        for (size_t& bin : changed) {
+            bin = binDis(gen);
+            merged[bin] += deltaDis(gen);
+        }
+    };
+
+    // warmup
+    change();
+    index.update(merged.data(), changed);
+
+    HistogramIndex truth;
+    for (size_t i = 0; i < iterations; ++i) {
+        change();
+        TIMING_BEGIN(testName, maxVal, changedCount, 1);
+        index.update(merged.data(), changed);
+        TIMING_END(testName, maxVal, changedCount, 1);
+
+        truth.build(merged.data(), maxVal);
+        for (size_t b = 0; b <= maxVal; ++b) {
+            if (index.prefix(b) != truth.prefix(b)) {
+                std::cout << "Error at index " << b << " -> Truth: " << truth.prefix(b) << " vs " << index.prefix(b) << std::endl;
+                abort();
+            }
+        }
+    }
+}
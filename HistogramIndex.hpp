@@ -0,0 +1,82 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_HISTOGRAMINDEX_HPP
+#define CUDAHISTOGRAMS_HISTOGRAMINDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+
+// bins per block of the index, 2KB of int64 prefixes.
+constexpr size_t HISTOGRAM_INDEX_BLOCK = 256;
+
+// Prefix sum index over a built histogram with non-negative counts. Kept in two levels: an inclusive scan
+// inside every block of HISTOGRAM_INDEX_BLOCK bins and the running total in front of every block. Range
+// counts and CDF are two lookups, a quantile is a binary search over the block totals (a few KB, stays in
+// cache) followed by one inside a single block. Changing a few bins only rescans their blocks and the block
+// totals behind them instead of the whole histogram.
+class HistogramIndex {
+    size_t binCount = 0;
+    std::vector<int64_t> inclusive;  // inclusive[b] = histogram[block start .. b]
+    std::vector<int64_t> blockBase;  // blockBase[k] = histogram[0 .. k * BLOCK), blockBase.back() is the total
+    SimdLevel level;
+
+    size_t blocks() const { return blockBase.size() - 1; }
+    // rescans block k from histogram and returns its total.
+    int64_t scanBlock(const int* histogram, size_t k);
+
+public:
+    explicit HistogramIndex(SimdLevel level = detectSimdLevel());
+
+    void build(const int* histogram, size_t bins);
+    // blocks split over the pool, then one serial pass over the block totals.
+    void build(const int* histogram, size_t bins, ThreadPool& pool);
+
+    // histogram is the whole, already modified histogram; changedBins lists the bins that differ from the
+    // last build or update, in any order and with duplicates.
+    void update(const int* histogram, std::span<const size_t> changedBins);
+
+    size_t bins() const { return binCount; }
+    int64_t total() const { return blockBase.back(); }
+
+    // histogram[0, bin) summed.
+    int64_t prefix(const size_t bin) const {
+        return bin == 0 ? 0 : blockBase[(bin - 1) / HISTOGRAM_INDEX_BLOCK] + inclusive[bin - 1];
+    }
+
+    int64_t count(const size_t bin) const { return prefix(bin + 1) - prefix(bin); }
+    // elements in bins [begin, end).
+    int64_t rangeCount(const size_t begin, const size_t end) const { return prefix(end) - prefix(begin); }
+    // share of the elements at or below bin.
+    double cdf(size_t bin) const;
+
+    // smallest bin whose cdf reaches q, q in [0, 1]. Throws std::domain_error on an empty histogram.
+    size_t quantile(double q) const;
+    // first bin where prefix(bin + 1) >= rank, for 1 <= rank <= total().
+    size_t binOfRank(int64_t rank) const;
+};
+
+// the scan every consumer used to write, kept as the reference for the index.
+size_t linearScanQuantile(const int* histogram, size_t bins, double q);
+int64_t linearScanRangeCount(const int* histogram, size_t begin, size_t end);
+
+// threadAmount == 1 builds serially, otherwise on pool.
+void profile_histogram_index_build(const std::shared_ptr<int[]> &histogram, size_t maxVal, size_t threadAmount, const std::string &testName,
+                                   size_t iterations, ThreadPool& pool);
+
+// queryCount quantile and as many range count queries, answered by the index (built outside the timing)
+// or by linear scans. Both are checked against the linear answers.
+void profile_histogram_index_queries(const std::shared_ptr<int[]> &histogram, size_t maxVal, size_t queryCount, bool useIndex, const std::string &testName,
+                                     size_t iterations);
+
+// changes changedCount random bins per iteration and updates the index, checked against a fresh build.
+void profile_histogram_index_update(const std::shared_ptr<int[]> &histogram, size_t maxVal, size_t changedCount, const std::string &testName, size_t iterations);
+
+#endif //CUDAHISTOGRAMS_HISTOGRAMINDEX_HPP
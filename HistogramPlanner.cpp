@@ -0,0 +1,309 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "HistogramPlanner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "PartitionedHistogram.hpp"
+#include "SimdHistogram.hpp"
+#include "Timer.hpp"
+
+namespace {
+    const char* solverName(const PlannedSolver solver) {
+        switch (solver) {
+            case PlannedSolver::Narrow:      return "narrow";
+            case PlannedSolver::Simd:        return "simd";
+            case PlannedSolver::Partitioned: return "partitioned";
+            default:                         return "reduced";
+        }
+    }
+
+    const char* reductionName(const ReductionStrategy reduction) {
+        return reduction == ReductionStrategy::Tree ? "tree" : "binsliced";
+    }
+
+    bool parsePlan(std::istringstream& in, HistogramPlan& plan) {
+        std::string solver, width, reduction;
+        if (!(in >> solver >> plan.threadCount >> width >> reduction) || plan.threadCount == 0) return false;
+
+        if (solver == "reduced") plan.solver = PlannedSolver::Reduced;
+        else if (solver == "narrow") plan.solver = PlannedSolver::Narrow;
+        else if (solver == "simd") plan.solver = PlannedSolver::Simd;
+        else if (solver == "partitioned") plan.solver = PlannedSolver::Partitioned;
+        else return false;
+
+        if (width == "u8") plan.counterWidth = CounterWidth::U8;
+        else if (width == "u16") plan.counterWidth = CounterWidth::U16;
+        else if (width == "u32") plan.counterWidth = CounterWidth::U32;
+        else return false;
+
+        if (reduction == "tree") plan.reduction = ReductionStrategy::Tree;
+        else if (reduction == "binsliced") plan.reduction = ReductionStrategy::BinSliced;
+        else return false;
+        return true;
+    }
+
+    template<typename Counter>
+    void executeNarrow(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const size_t dataSize, const size_t maxVal,
+                       const size_t threadCount, const PlanScratch& scratch, ThreadPool& pool) {
+        // the counters live in the int scratch, the narrow solver zeroes its own counters and spills.
+        const std::shared_ptr<Counter[]> narrow(scratch.primary, reinterpret_cast<Counter*>(scratch.primary.get()));
+
+        if constexpr (sizeof(Counter) < sizeof(int)) {
+            const NarrowFlush flush = selectNarrowFlush(sizeof(Counter) == 1 ? CounterWidth::U8 : CounterWidth::U16, maxVal);
+            if (flush == NarrowFlush::ElementBudget) {
+                solveThreadedNarrowHistogram<Counter, NarrowFlush::ElementBudget>(data, histogram, narrow, scratch.wide, dataSize, maxVal, threadCount,
+                    scratch.perThreadCounters, scratch.perThreadInts, pool);
+                return;
+            }
+        }
+        solveThreadedNarrowHistogram<Counter, NarrowFlush::Saturation>(data, histogram, narrow, scratch.wide, dataSize, maxVal, threadCount,
+            scratch.perThreadCounters, scratch.perThreadInts, pool);
+    }
+
+    size_t counterBytes(const CounterWidth width) {
+        switch (width) {
+            case CounterWidth::U8:  return sizeof(uint8_t);
+            case CounterWidth::U16: return sizeof(uint16_t);
+            default:                return sizeof(uint32_t);
+        }
+    }
+}
+
+std::string HistogramPlan::describe() const {
+    std::ostringstream oss;
+    oss << solverName(solver) << ", " << threadCount << " threads";
+    if (solver == PlannedSolver::Narrow) oss << ", " << counterWidthName(counterWidth);
+    if (solver == PlannedSolver::Reduced) oss << ", " << reductionName(reduction);
+    return oss.str();
+}
+
+HistogramPlanner::HistogramPlanner(std::string cachePath) : cachePath(std::move(cachePath)) {
+    load();
+}
+
+std::string HistogramPlanner::key(const size_t maxVal, const std::string& elementType) const {
+    return machineInfo().id() + "|" + std::to_string(maxVal) + "|" + elementType;
+}
+
+void HistogramPlanner::load() {
+    std::ifstream in(cachePath);
+    for (std::string line; std::getline(in, line);) {
+        std::istringstream fields(line);
+        std::string planKey;
+        HistogramPlan plan;
+        // later lines win, a re-tuned configuration is simply appended.
+        if (fields >> planKey && parsePlan(fields, plan)) {
+            plans[planKey] = plan;
+        }
+    }
+}
+
+void HistogramPlanner::save(const std::string& planKey, const HistogramPlan& plan) const {
+    std::ofstream out(cachePath, std::ios::app);
+    if (!out) {
+        std::cerr << "Could not write plan cache " << cachePath << std::endl;
+        return;
+    }
+    out << planKey << " " << solverName(plan.solver) << " " << plan.threadCount << " "
+        << counterWidthName(plan.counterWidth) << " " << reductionName(plan.reduction) << "\n";
+}
+
+bool HistogramPlanner::isCached(const size_t maxVal, const std::string& elementType) const {
+    return plans.contains(key(maxVal, elementType));
+}
+
+ThreadPool& HistogramPlanner::poolFor(const size_t threadCount) {
+    if (!pool || pool->size() != threadCount) {
+        pool.reset();
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+    return *pool;
+}
+
+HistogramPlan HistogramPlanner::plan(const std::shared_ptr<int[]>& data, const size_t dataSize, const size_t maxVal, const std::string& elementType) {
+    const std::string planKey = key(maxVal, elementType);
+    if (const auto it = plans.find(planKey); it != plans.end()) {
+        tuningMs = 0.0;
+        scratchFor(it->second, dataSize, maxVal);
+        return it->second;
+    }
+
+    const auto start = timing::clock::now();
+    const HistogramPlan tuned = tune(data, dataSize, maxVal);
+    tuningMs = std::chrono::duration<double, std::milli>(timing::clock::now() - start).count();
+
+    plans[planKey] = tuned;
+    save(planKey, tuned);
+    scratchFor(tuned, dataSize, maxVal);
+    return tuned;
+}
+
+HistogramPlan HistogramPlanner::tune(const std::shared_ptr<int[]>& data, const size_t dataSize, const size_t maxVal) {
+    const MachineInfo& machine = machineInfo();
+    const size_t sampleSize = std::min(dataSize, PLANNER_SAMPLE_ELEMENTS);
+
+    // powers of two plus the physical and logical core counts.
+    std::set<size_t> threadCounts = {machine.physicalCores, machine.logicalCores};
+    for (size_t t = 1; t < machine.logicalCores; t *= 2) {
+        threadCounts.insert(t);
+    }
+
+    std::vector<HistogramPlan> candidates;
+    for (const size_t threads : threadCounts) {
+        if (isPowerOfTwo(threads)) {
+            candidates.push_back({PlannedSolver::Reduced, threads, CounterWidth::U32, ReductionStrategy::Tree});
+        }
+        candidates.push_back({PlannedSolver::Reduced, threads, CounterWidth::U32, ReductionStrategy::BinSliced});
+        const CounterWidth width = selectCounterWidth(maxVal, machine.l1dBytes, machine.l2Bytes);
+        if (width != CounterWidth::U32) {
+            candidates.push_back({PlannedSolver::Narrow, threads, width, ReductionStrategy::BinSliced});
+        }
+        candidates.push_back({PlannedSolver::Simd, threads, CounterWidth::U32, ReductionStrategy::BinSliced});
+        candidates.push_back({PlannedSolver::Partitioned, threads, CounterWidth::U32, ReductionStrategy::BinSliced});
+    }
+
+    const std::shared_ptr<int[]> sampleHistogram(new int[maxVal]);
+    HistogramPlan best = candidates.front();
+    double bestMs = std::numeric_limits<double>::max();
+    for (const HistogramPlan& candidate : candidates) {
+        execute(candidate, data, sampleHistogram, sampleSize, maxVal); // warmup
+
+        double candidateMs = std::numeric_limits<double>::max();
+        for (size_t run = 0; run < PLANNER_SAMPLE_RUNS; ++run) {
+            prepare(candidate, sampleSize, maxVal);
+            const auto start = timing::clock::now();
+            execute(candidate, data, sampleHistogram, sampleSize, maxVal);
+            candidateMs = std::min(candidateMs, std::chrono::duration<double, std::milli>(timing::clock::now() - start).count());
+        }
+        if (candidateMs < bestMs) {
+            bestMs = candidateMs;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+PlanScratch& HistogramPlanner::scratchFor(const HistogramPlan& plan, const size_t dataSize, const size_t maxVal) {
+    const size_t elements = plan.solver == PlannedSolver::Partitioned ? dataSize : 0;
+    const auto [it, inserted] = scratch.try_emplace({plan.solver, plan.threadCount, plan.counterWidth, elements, maxVal});
+    if (!inserted) return it->second;
+
+    // one plan runs at a time, and a partitioned plan's scratch is as large as its input.
+    for (auto other = scratch.begin(); other != scratch.end();) {
+        other = other == it ? std::next(other) : scratch.erase(other);
+    }
+    PlanScratch& s = it->second;
+
+    const size_t threads = plan.threadCount;
+    const size_t pageSize = systemPageSize();
+    const size_t pageInts = pageSize / sizeof(int);
+    switch (plan.solver) {
+        case PlannedSolver::Reduced:
+            s.perThreadInts = reducedPerThreadBytesPaged(maxVal, pageSize) / sizeof(int);
+            s.primaryInts = s.perThreadInts * threads;
+            break;
+        case PlannedSolver::Narrow: {
+            const size_t bytes = counterBytes(plan.counterWidth);
+            s.perThreadCounters = (maxVal * bytes + pageSize - 1) / pageSize * pageSize / bytes;
+            s.primaryInts = s.perThreadCounters * bytes * threads / sizeof(int);
+            s.perThreadInts = reducedPerThreadBytesPaged(maxVal, pageSize) / sizeof(int);
+            s.wide = makeAlignedArray<int>(s.perThreadInts * threads, pageSize);
+            clear(s.wide.get(), s.perThreadInts * threads);
+            break;
+        }
+        case PlannedSolver::Simd:
+            s.perThreadInts = (maxVal * simdHistogramCopies(detectSimdLevel()) + pageInts - 1) / pageInts * pageInts;
+            s.primaryInts = s.perThreadInts * threads;
+            break;
+        case PlannedSolver::Partitioned:
+            s.primaryInts = std::max<size_t>(dataSize, 1);
+            s.bucketCounts.reset(new size_t[threads * planPartitionLayout(maxVal, threads, machineInfo().l1dBytes / 2).countStride]);
+            break;
+    }
+    s.primary = makeAlignedArray<int>(s.primaryInts, pageSize);
+    // zeroing also faults every page in now rather than in the first timed solve.
+    clear(s.primary.get(), s.primaryInts);
+    return s;
+}
+
+void HistogramPlanner::trim() {
+    scratch.clear();
+}
+
+PlanScratch& HistogramPlanner::prepare(const HistogramPlan& plan, const size_t dataSize, const size_t maxVal) {
+    PlanScratch& s = scratchFor(plan, dataSize, maxVal);
+    if (s.dirty) {
+        clear(s.primary.get(), s.primaryInts);
+        s.dirty = false;
+    }
+    return s;
+}
+
+void HistogramPlanner::execute(const HistogramPlan& plan, const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram,
+                               const size_t dataSize, const size_t maxVal) {
+    const size_t threads = plan.threadCount;
+    ThreadPool& threadPool = poolFor(threads);
+    // the reduced and simd solvers count into zeroed private histograms and leave them summed up.
+    PlanScratch& s = prepare(plan, dataSize, maxVal);
+
+    switch (plan.solver) {
+        case PlannedSolver::Reduced: {
+            const size_t perThreadBytesPaged = s.perThreadInts * sizeof(int);
+            const size_t reducedSize = perThreadBytesPaged * threads;
+            if (plan.reduction == ReductionStrategy::Tree) {
+                solveThreadedReducedHistogram<false, false, false, false, ReductionStrategy::Tree>(data, histogram, s.primary,
+                    dataSize, maxVal, threads, systemPageSize(), reducedSize, perThreadBytesPaged, threadPool);
+            } else {
+                solveThreadedReducedHistogram<false, false, false, false, ReductionStrategy::BinSliced>(data, histogram, s.primary,
+                    dataSize, maxVal, threads, systemPageSize(), reducedSize, perThreadBytesPaged, threadPool);
+            }
+            s.dirty = true;
+            break;
+        }
+        case PlannedSolver::Narrow:
+            switch (plan.counterWidth) {
+                case CounterWidth::U8:  executeNarrow<uint8_t>(data, histogram, dataSize, maxVal, threads, s, threadPool);  break;
+                case CounterWidth::U16: executeNarrow<uint16_t>(data, histogram, dataSize, maxVal, threads, s, threadPool); break;
+                case CounterWidth::U32: executeNarrow<uint32_t>(data, histogram, dataSize, maxVal, threads, s, threadPool); break;
+            }
+            break;
+        case PlannedSolver::Simd:
+            solveThreadedSimdHistogram(data, histogram, s.primary, dataSize, maxVal, threads, s.perThreadInts, detectSimdLevel(), threadPool);
+            s.dirty = true;
+            break;
+        case PlannedSolver::Partitioned: {
+            const PartitionLayout layout = planPartitionLayout(maxVal, threads, machineInfo().l1dBytes / 2);
+            solveThreadedPartitionedHistogram(data, histogram, s.primary, s.bucketCounts, dataSize, maxVal, threads, layout, threadPool);
+            break;
+        }
+    }
+}
+
+void profile_planned_cpu_histogram(HistogramPlanner& planner, const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                   const size_t dataSize, const int maxVal, const std::string &testName, const size_t iterations) {
+    const HistogramPlan plan = planner.plan(data, dataSize, maxVal);
+    std::cout << "[plan " << plan.describe() << (planner.lastTuningMs() == 0.0 ? ", cached" : ", tuned in " + std::to_string(planner.lastTuningMs()) + " ms") << "] " << std::flush;
+
+    // warmup
+    planner.execute(plan, data, testHistogram, dataSize, maxVal);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        planner.prepare(plan, dataSize, maxVal);
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, plan.threadCount);
+        // looking the plan up again is part of the cost of running through the planner.
+        planner.execute(planner.plan(data, dataSize, maxVal), data, testHistogram, dataSize, maxVal);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, plan.threadCount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
@@ -0,0 +1,92 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_HISTOGRAMPLANNER_HPP
+#define CUDAHISTOGRAMS_HISTOGRAMPLANNER_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "Common.hpp"
+#include "MachineInfo.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedNarrowHistogram.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+constexpr auto DEFAULT_PLAN_CACHE = "histogram_plans.txt";
+// prefix of the input the candidates are timed on.
+constexpr size_t PLANNER_SAMPLE_ELEMENTS = 1 << 22;
+constexpr size_t PLANNER_SAMPLE_RUNS = 3;
+
+enum class PlannedSolver {
+    Reduced,
+    Narrow,
+    Simd,
+    Partitioned
+};
+
+struct HistogramPlan {
+    PlannedSolver solver = PlannedSolver::Reduced;
+    size_t threadCount = 1;
+    CounterWidth counterWidth = CounterWidth::U32;
+    ReductionStrategy reduction = ReductionStrategy::BinSliced;
+
+    std::string describe() const;
+};
+
+// buffers a plan solves into besides the output, allocated once per (plan, sizes) and reused by every execute().
+struct PlanScratch {
+    std::shared_ptr<int[]> primary;         // private histograms, narrow counters or the partitioned input
+    std::shared_ptr<int[]> wide;            // narrow: the int histograms the counters spill into
+    std::shared_ptr<size_t[]> bucketCounts; // partitioned
+    size_t primaryInts = 0;
+    size_t perThreadInts = 0;
+    size_t perThreadCounters = 0;
+    bool dirty = false;                     // primary has to be zeroed before the next solve
+};
+
+// Picks solver, thread count, counter width and reduction per (machine, bin count, element type) by timing
+// the candidates on a sample of the input. Plans are persisted to cachePath, so after the first call for a
+// configuration plan() is a map lookup.
+class HistogramPlanner {
+    std::string cachePath;
+    std::map<std::string, HistogramPlan> plans;
+    std::unique_ptr<ThreadPool> pool;
+    double tuningMs = 0.0;
+    // (solver, threads, counter width, elements, bins), elements only matter to the partitioned solver. Holds
+    // at most the scratch of the plan that ran last.
+    std::map<std::tuple<PlannedSolver, size_t, CounterWidth, size_t, size_t>, PlanScratch> scratch;
+
+    std::string key(size_t maxVal, const std::string& elementType) const;
+    void load();
+    void save(const std::string& planKey, const HistogramPlan& plan) const;
+    HistogramPlan tune(const std::shared_ptr<int[]>& data, size_t dataSize, size_t maxVal);
+    PlanScratch& scratchFor(const HistogramPlan& plan, size_t dataSize, size_t maxVal);
+
+public:
+    explicit HistogramPlanner(std::string cachePath = DEFAULT_PLAN_CACHE);
+
+    // also allocates the returned plan's scratch for dataSize x maxVal.
+    HistogramPlan plan(const std::shared_ptr<int[]>& data, size_t dataSize, size_t maxVal, const std::string& elementType = "int32");
+    bool isCached(size_t maxVal, const std::string& elementType = "int32") const;
+
+    // time spent tuning in the last plan() call, 0 when it came from the cache.
+    double lastTuningMs() const { return tuningMs; }
+
+    // pool with exactly threadCount workers, kept around between calls.
+    ThreadPool& poolFor(size_t threadCount);
+
+    // zeroes scratch a previous execute() left dirty, so the next execute() neither allocates nor clears.
+    PlanScratch& prepare(const HistogramPlan& plan, size_t dataSize, size_t maxVal);
+    // frees the scratch of the last plan, the next plan()/execute() allocates it again.
+    void trim();
+    void execute(const HistogramPlan& plan, const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, size_t dataSize, size_t maxVal);
+};
+
+void profile_planned_cpu_histogram(HistogramPlanner& planner, const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                   size_t dataSize, int maxVal, const std::string &testName, size_t iterations);
+
+#endif //CUDAHISTOGRAMS_HISTOGRAMPLANNER_HPP
@@ -0,0 +1,127 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "HistogramStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "ThreadedReducedHistogram.hpp"
+
+HistogramStream::HistogramStream(const size_t maxVal, const size_t threadAmount, ThreadPool& pool, const size_t chunkCapacity)
+    : maxVal(maxVal), threadAmount(threadAmount), chunkCapacity(chunkCapacity),
+      perThreadInts(reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int)), pool(pool) {
+    privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    buffers[0] = makeAlignedArray<int>(chunkCapacity, systemPageSize());
+    buffers[1] = makeAlignedArray<int>(chunkCapacity, systemPageSize());
+    reset();
+}
+
+HistogramStream::~HistogramStream() {
+    // the workers still reference our buffers.
+    for (auto& future : inFlight) {
+        if (future.valid()) future.wait();
+    }
+}
+
+void HistogramStream::wait() {
+    for (auto& future : inFlight) {
+        future.get();
+    }
+    inFlight.clear();
+}
+
+void HistogramStream::dispatch() {
+    // the other buffer has to be counted before we start refilling it, which also keeps
+    // a single task per private histogram in flight.
+    wait();
+
+    const size_t count = filled;
+    const size_t elementsPerThread = (count + threadAmount - 1) / threadAmount;
+    const int* chunk = buffers[fillIndex].get();
+
+    for (size_t t = 0; t < threadAmount; ++t) {
+        inFlight.push_back(pool.queue([=, this]() {
+            int* hist = privateHistograms.get() + t * perThreadInts;
+            const size_t start = std::min(t * elementsPerThread, count);
+            const size_t end   = std::min(start + elementsPerThread, count);
+            for (size_t i = start; i < end; ++i) {
+                ++hist[chunk[i]];
+            }
+        }));
+    }
+
+    fillIndex ^= 1;
+    filled = 0;
+}
+
+std::span<int> HistogramStream::fillBuffer() {
+    return {buffers[fillIndex].get() + filled, chunkCapacity - filled};
+}
+
+void HistogramStream::commit(const size_t count) {
+    if (count > chunkCapacity - filled) {
+        throw std::out_of_range("committed " + std::to_string(count) + " values, fillBuffer() only had room for " + std::to_string(chunkCapacity - filled));
+    }
+    filled += count;
+    totalElements += count;
+    if (filled == chunkCapacity) {
+        dispatch();
+    }
+}
+
+void HistogramStream::push(std::span<const int> chunk) {
+    while (!chunk.empty()) {
+        const std::span<int> target = fillBuffer();
+        const size_t count = std::min(target.size(), chunk.size());
+        std::memcpy(target.data(), chunk.data(), count * sizeof(int));
+        chunk = chunk.subspan(count);
+        commit(count);
+    }
+}
+
+void HistogramStream::finalize(int* histogram) {
+    if (filled != 0) {
+        dispatch();
+    }
+    wait();
+
+    reduceBinSliced(privateHistograms.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+}
+
+void HistogramStream::reset() {
+    wait();
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+    fillIndex = 0;
+    filled = 0;
+    totalElements = 0;
+}
+
+void profile_histogram_stream_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                            const size_t dataSize, const int maxVal, const size_t threadAmount, const size_t chunkSize, const std::string &testName,
+                                            const size_t iterations, ThreadPool& pool) {
+    HistogramStream stream(static_cast<size_t>(maxVal), threadAmount, pool, chunkSize);
+
+    // feeds the data the way a producer would, one chunk at a time.
+    const auto run = [&]() {
+        for (size_t offset = 0; offset < dataSize; offset += chunkSize) {
+            stream.push({data.get() + offset, std::min(chunkSize, dataSize - offset)});
+        }
+        stream.finalize(testHistogram.get());
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        stream.reset();
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        run();
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
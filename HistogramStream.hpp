@@ -0,0 +1,68 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_HISTOGRAMSTREAM_HPP
+#define CUDAHISTOGRAMS_HISTOGRAMSTREAM_HPP
+
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+
+constexpr size_t DEFAULT_STREAM_CHUNK = 1 << 20;
+
+// Incremental histogram over data that arrives in chunks. Every thread keeps its private histogram
+// (same page padded layout as the reduced solver) alive across chunks, and the stream double buffers
+// so the producer fills one chunk while the pool counts the other. The reduction runs once, in finalize().
+// push/fillBuffer/commit/finalize must be called from a single producer thread.
+class HistogramStream {
+    const size_t maxVal;
+    const size_t threadAmount;
+    const size_t chunkCapacity;
+    const size_t perThreadInts;
+    ThreadPool& pool;
+
+    std::shared_ptr<int[]> privateHistograms;
+    std::shared_ptr<int[]> buffers[2];
+    size_t fillIndex = 0;
+    size_t filled = 0;
+    size_t totalElements = 0;
+    std::vector<std::future<void>> inFlight;
+
+    void dispatch();
+    void wait();
+
+public:
+    HistogramStream(size_t maxVal, size_t threadAmount, ThreadPool& pool, size_t chunkCapacity = DEFAULT_STREAM_CHUNK);
+    ~HistogramStream();
+
+    HistogramStream(const HistogramStream&) = delete;
+    HistogramStream& operator=(const HistogramStream&) = delete;
+
+    // copies the chunk into the staging buffer, handing full buffers to the pool as it goes.
+    void push(std::span<const int> chunk);
+
+    // zero copy alternative to push: write up to fillBuffer().size() values, then commit how many were written.
+    // Committing more than that throws std::out_of_range.
+    std::span<int> fillBuffer();
+    void commit(size_t count);
+
+    // counts what is left in the staging buffer and reduces every private histogram into histogram[0, maxVal).
+    void finalize(int* histogram);
+
+    // starts a new stream, forgetting everything pushed so far.
+    void reset();
+
+    size_t elementsPushed() const { return totalElements; }
+};
+
+void profile_histogram_stream_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                            size_t dataSize, int maxVal, size_t threadAmount, size_t chunkSize, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_HISTOGRAMSTREAM_HPP
@@ -0,0 +1,135 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "HistogramWorkspace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+const char* hugePageModeName(const HugePageMode mode) {
+    switch (mode) {
+        case HugePageMode::Transparent: return "transparent";
+        case HugePageMode::Explicit:    return "explicit";
+        default:                        return "none";
+    }
+}
+
+WorkspaceArena::WorkspaceArena(const size_t requestedBytes, const HugePageMode requested)
+    : bytes((std::max<size_t>(requestedBytes, 1) + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES) {
+#if defined(_WIN32)
+    if (requested == HugePageMode::Explicit) {
+        // needs SeLockMemoryPrivilege, without it this fails and we take normal pages.
+        const size_t large = GetLargePageMinimum();
+        if (large != 0) {
+            const size_t largeBytes = (bytes + large - 1) / large * large;
+            base = VirtualAlloc(nullptr, largeBytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (base) {
+                bytes = largeBytes;
+                mode = HugePageMode::Explicit;
+                return;
+            }
+        }
+    }
+    base = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (!base) throw std::bad_alloc();
+#else
+    if (requested == HugePageMode::Explicit) {
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            mode = HugePageMode::Explicit;
+            return;
+        }
+    }
+
+    // over map by one huge page and trim, so the transparent huge pages can line up.
+    void* raw = mmap(nullptr, bytes + HUGE_PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    const auto rawAddress = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (rawAddress + HUGE_PAGE_BYTES - 1) & ~(uintptr_t{HUGE_PAGE_BYTES} - 1);
+    if (aligned > rawAddress) munmap(raw, aligned - rawAddress);
+    if (const size_t tail = rawAddress + HUGE_PAGE_BYTES - aligned; tail > 0) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    base = reinterpret_cast<void*>(aligned);
+
+#if defined(MADV_HUGEPAGE)
+    if (requested != HugePageMode::None && madvise(base, bytes, MADV_HUGEPAGE) == 0) {
+        mode = HugePageMode::Transparent;
+    }
+#endif
+#endif
+}
+
+WorkspaceArena::~WorkspaceArena() {
+#if defined(_WIN32)
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, bytes);
+#endif
+}
+
+HistogramWorkspace::HistogramWorkspace(const size_t maxVal, const size_t threadAmount, const HugePageMode mode)
+    : maxVal(maxVal), threadAmount(threadAmount),
+      perThreadInts(reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int)),
+      arena(perThreadInts * threadAmount * sizeof(int), mode) {}
+
+std::shared_ptr<HistogramWorkspace> WorkspacePool::acquire(const size_t maxVal, const size_t threadAmount) {
+    const auto key = std::make_pair(maxVal, threadAmount);
+    std::unique_ptr<HistogramWorkspace> workspace;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto& list = idle[key]; !list.empty()) {
+            workspace = std::move(list.back());
+            list.pop_back();
+        }
+    }
+    if (!workspace) {
+        workspace = std::make_unique<HistogramWorkspace>(maxVal, threadAmount, mode);
+    }
+
+    return std::shared_ptr<HistogramWorkspace>(workspace.release(), [this, key](HistogramWorkspace* returned) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle[key].emplace_back(returned);
+    });
+}
+
+void WorkspacePool::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.clear();
+}
+
+size_t WorkspacePool::idleCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& [key, list] : idle) {
+        count += list.size();
+    }
+    return count;
+}
+
+WorkspacePool& workspacePool() {
+    static WorkspacePool pool;
+    return pool;
+}
+
+void profile_threaded_workspace_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                              const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const std::shared_ptr<HistogramWorkspace> workspace = workspacePool().acquire(maxVal, threadAmount);
+
+    // warmup
+    solveWorkspaceHistogram(data, testHistogram, dataSize, *workspace, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // only so validate catches a bin that was never written.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveWorkspaceHistogram(data, testHistogram, dataSize, *workspace, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
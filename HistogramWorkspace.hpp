@@ -0,0 +1,111 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_HISTOGRAMWORKSPACE_HPP
+#define CUDAHISTOGRAMS_HISTOGRAMWORKSPACE_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common.hpp"
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+constexpr size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+enum class HugePageMode {
+    None,
+    Transparent,    // madvise(MADV_HUGEPAGE), the kernel backs what it can
+    Explicit        // MAP_HUGETLB / MEM_LARGE_PAGES, falls back to Transparent when none are reserved
+};
+
+const char* hugePageModeName(HugePageMode mode);
+
+// zeroed memory straight from the OS, rounded up to whole huge pages.
+class WorkspaceArena {
+    void* base = nullptr;
+    size_t bytes = 0;
+    HugePageMode mode = HugePageMode::None;
+public:
+    WorkspaceArena(size_t bytes, HugePageMode requested);
+    ~WorkspaceArena();
+
+    WorkspaceArena(const WorkspaceArena&) = delete;
+    WorkspaceArena& operator=(const WorkspaceArena&) = delete;
+
+    void* data() const { return base; }
+    size_t size() const { return bytes; }
+    // what the arena actually got, which may be less than what was asked for.
+    HugePageMode backing() const { return mode; }
+};
+
+// The private histograms of one (bin count, thread count) configuration, kept between calls. Every private
+// slice is all zero whenever no solve is running: the arena starts zeroed and the reducer zeroes each
+// slice as it reads it, so there is never a separate clearing pass.
+class HistogramWorkspace {
+    const size_t maxVal;
+    const size_t threadAmount;
+    const size_t perThreadInts;
+    WorkspaceArena arena;
+public:
+    HistogramWorkspace(size_t maxVal, size_t threadAmount, HugePageMode mode = HugePageMode::Transparent);
+
+    int* privateHistograms() const { return static_cast<int*>(arena.data()); }
+    size_t perThread() const { return perThreadInts; }
+    size_t bins() const { return maxVal; }
+    size_t threads() const { return threadAmount; }
+    HugePageMode backing() const { return arena.backing(); }
+};
+
+// Idle workspaces per (bin count, thread count). acquire() hands out an idle one or builds a new one, and
+// dropping the last reference puts it back, so concurrent users of a configuration never share one.
+class WorkspacePool {
+    std::mutex mutex;
+    std::map<std::pair<size_t, size_t>, std::vector<std::unique_ptr<HistogramWorkspace>>> idle;
+    const HugePageMode mode;
+public:
+    explicit WorkspacePool(HugePageMode mode = HugePageMode::Transparent) : mode(mode) {}
+
+    std::shared_ptr<HistogramWorkspace> acquire(size_t maxVal, size_t threadAmount);
+
+    // frees every idle workspace, leased ones come back as usual.
+    void trim();
+    size_t idleCount();
+};
+
+WorkspacePool& workspacePool();
+
+// bin sliced solve on a pooled workspace: count into the private slices, then one pass that sums and
+// zeroes them. Nothing is cleared before or after.
+template<typename Pool = ThreadPool>
+void solveWorkspaceHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const size_t dataSize,
+                             const HistogramWorkspace& workspace, Pool& pool) {
+    const size_t threadAmount = workspace.threads();
+    const size_t perThreadInts = workspace.perThread();
+    int* privateHistograms = workspace.privateHistograms();
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &data](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        int* hist = privateHistograms + t * perThreadInts;
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        for (size_t i = start; i < end; ++i) {
+            ++hist[data[i]];
+        }
+    }).wait();
+
+    reduceBinSliced<true>(privateHistograms, perThreadInts, threadAmount, histogram, workspace.bins(), threadAmount, pool);
+}
+
+void profile_threaded_workspace_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                              size_t dataSize, int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_HISTOGRAMWORKSPACE_HPP
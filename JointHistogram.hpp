@@ -0,0 +1,180 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_JOINTHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_JOINTHISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "BinMapper.hpp"
+#include "BinnedHistogram.hpp"
+#include "Common.hpp"
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+// One column of a joint histogram (structure of arrays: every axis has its own column, all dataSize long)
+// and the mapper that bins it. The axis is mapper.histogramSize() bins wide, under/overflow bins included.
+template<typename T, typename Mapper>
+struct JointAxis {
+    std::shared_ptr<T[]> column;
+    Mapper mapper;
+
+    size_t extent() const { return mapper.histogramSize(); }
+};
+
+template<typename T, typename Mapper> requires (!std::is_integral_v<Mapper>)
+JointAxis<T, Mapper> makeJointAxis(const std::shared_ptr<T[]>& column, const Mapper& mapper) {
+    return {column, mapper};
+}
+
+// int column already in [0, maxVal), like the one dimensional solvers take.
+inline JointAxis<int, IdentityMapper<int>> makeJointAxis(const std::shared_ptr<int[]>& column, const size_t maxVal) {
+    return {column, IdentityMapper<int>(maxVal)};
+}
+
+// row major: the first axis varies slowest.
+template<typename... Axes>
+size_t jointBinCount(const Axes&... axes) {
+    return (axes.extent() * ...);
+}
+
+// When the joint bin space is bigger than tileBytes, threads are split into tiles groups. Every group owns
+// tileBins consecutive joint bins and scans the whole input, so each private histogram stays cache sized
+// at the cost of reading the input once per tile.
+struct JointLayout {
+    size_t tiles;
+    size_t tileBins;
+    size_t perThreadInts;   // tileBins, page padded
+};
+
+inline JointLayout planJointLayout(const size_t jointBins, const size_t threadAmount, const size_t tileBytes) {
+    if (jointBins == 0 || jointBins >= std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("joint histograms need between 1 and 2^32 - 1 bins");
+    }
+    constexpr size_t binsPerCacheLine = std::hardware_destructive_interference_size / sizeof(int);
+    const size_t budgetBins = std::max<size_t>(tileBytes / sizeof(int), binsPerCacheLine);
+    const size_t tiles = std::clamp<size_t>((jointBins + budgetBins - 1) / budgetBins, 1, threadAmount);
+    const size_t tileBins = ((jointBins + tiles - 1) / tiles + binsPerCacheLine - 1) / binsPerCacheLine * binsPerCacheLine;
+    return {tiles, tileBins, reducedPerThreadBytesPaged(tileBins, systemPageSize()) / sizeof(int)};
+}
+
+namespace detail {
+    // indices = indices * extent + bin, one vectorizable pass per axis.
+    template<typename Axis>
+    void mapJointAxis(const Axis& axis, const size_t base, const size_t n, uint32_t* indices) {
+        const auto* column = axis.column.get() + base;
+        const auto extent = static_cast<uint32_t>(axis.extent());
+        for (size_t i = 0; i < n; ++i) {
+            indices[i] = indices[i] * extent + axis.mapper(column[i]);
+        }
+    }
+}
+
+// counts joint bins [tileBegin, tileBegin + tileBins) of elements [start, end) into hist. With more than one
+// tile, the block's in-tile indices are first compacted without branching (every index is stored, only the
+// in-tile ones advance the cursor), so out-of-tile elements cost no increment at all.
+template<typename... Axes>
+void countJoint(const size_t start, const size_t end, int* hist, const size_t tileBegin, const size_t tileBins, const bool tiled, const Axes&... axes) {
+    alignas(64) uint32_t indices[BIN_MAP_BLOCK];
+    for (size_t base = start; base < end; base += BIN_MAP_BLOCK) {
+        const size_t n = std::min(BIN_MAP_BLOCK, end - base);
+        std::fill_n(indices, n, 0u);
+        (detail::mapJointAxis(axes, base, n, indices), ...);
+
+        if (!tiled) {
+            for (size_t i = 0; i < n; ++i) {
+                ++hist[indices[i]];
+            }
+        } else {
+            size_t kept = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const size_t local = indices[i] - tileBegin; // wraps for indices below the tile
+                indices[kept] = static_cast<uint32_t>(local);
+                kept += local < tileBins;
+            }
+            for (size_t i = 0; i < kept; ++i) {
+                ++hist[indices[i]];
+            }
+        }
+    }
+}
+
+template<typename U, typename... Axes>
+void solveJointNaiveHistogram(const U& histogram, const size_t dataSize, const Axes&... axes) {
+    for (size_t i = 0; i < dataSize; ++i) {
+        size_t index = 0;
+        ((index = index * axes.extent() + axes.mapper(axes.column[i])), ...);
+        ++histogram[index];
+    }
+}
+
+// privateHistograms holds threadAmount * layout.perThreadInts ints and must be zero on entry, the solve
+// leaves it zeroed again. Thread t counts tile t % tiles over its share of the input.
+template<typename Pool, typename... Axes>
+void solveThreadedJointHistogram(const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    const size_t dataSize, const size_t threadAmount, const JointLayout& layout, Pool& pool, const Axes&... axes) {
+    const size_t jointBins = jointBinCount(axes...);
+    const size_t tiles = layout.tiles;
+    const size_t tileBins = layout.tileBins;
+    const size_t perThreadInts = layout.perThreadInts;
+    const bool tiled = tiles > 1;
+
+    pool.parallel_for(0, threadAmount, 1, [&, jointBins](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        const size_t tile = t % tiles;
+        const size_t member = t / tiles;
+        const size_t members = (threadAmount - tile + tiles - 1) / tiles;
+        const size_t elementsPerMember = (dataSize + members - 1) / members;
+        const size_t start = std::min(member * elementsPerMember, dataSize);
+        const size_t end   = std::min(start + elementsPerMember, dataSize);
+
+        int* hist = privateHistograms.get() + t * perThreadInts;
+        countJoint(start, end, hist, tiled ? tile * tileBins : 0, tiled ? tileBins : jointBins, tiled, axes...);
+    }).wait();
+
+    // thread t's private histogram is member t / tiles of tile t % tiles, so one tile's members sit
+    // tiles * perThreadInts apart.
+    for (size_t tile = 0; tile < tiles; ++tile) {
+        const size_t tileBegin = std::min(tile * tileBins, jointBins);
+        const size_t tileEnd   = std::min(tileBegin + tileBins, jointBins);
+        const size_t members = (threadAmount - tile + tiles - 1) / tiles;
+        reduceBinSliced<true>(privateHistograms.get() + tile * perThreadInts, tiles * perThreadInts, members,
+                              histogram.get() + tileBegin, tileEnd - tileBegin, threadAmount, pool);
+    }
+}
+
+// tileBytes is the private histogram budget per thread, e.g. half of L2. SIZE_MAX never tiles.
+template<typename Pool, typename... Axes>
+void profile_threaded_joint_cpu_histogram(const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                          const size_t dataSize, const size_t threadAmount, const size_t tileBytes, const std::string &testName,
+                                          const size_t iterations, Pool& pool, const Axes&... axes) {
+    const size_t jointBins = jointBinCount(axes...);
+    const JointLayout layout = planJointLayout(jointBins, threadAmount, tileBytes);
+    const size_t privateInts = layout.perThreadInts * threadAmount;
+    const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(privateInts, systemPageSize());
+    clear(privateHistograms.get(), privateInts);
+
+    // warmup
+    solveThreadedJointHistogram(testHistogram, privateHistograms, dataSize, threadAmount, layout, pool, axes...);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), jointBins); // clear last test if any.
+        TIMING_BEGIN(testName, jointBins, dataSize, threadAmount);
+        solveThreadedJointHistogram(testHistogram, privateHistograms, dataSize, threadAmount, layout, pool, axes...);
+        TIMING_END(testName, jointBins, dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, jointBins);
+    }
+    std::lock_guard<std::mutex> lock(timing::mutex());
+    timing::elementBytes()[{testName, jointBins, dataSize, threadAmount}] = (sizeof(*axes.column.get()) + ...);
+}
+
+#endif //CUDAHISTOGRAMS_JOINTHISTOGRAM_HPP
@@ -0,0 +1,207 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "MachineInfo.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace {
+#if !defined(_WIN32)
+    bool readLine(const std::string& path, std::string& line) {
+        std::ifstream in(path);
+        return in && std::getline(in, line);
+    }
+
+    // sysfs cache sizes look like "48K" or "32768K".
+    size_t parseSize(const std::string& text) {
+        size_t value = 0;
+        size_t i = 0;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+            value = value * 10 + static_cast<size_t>(text[i++] - '0');
+        }
+        if (i < text.size()) {
+            switch (text[i]) {
+                case 'K': value <<= 10; break;
+                case 'M': value <<= 20; break;
+                case 'G': value <<= 30; break;
+                default: break;
+            }
+        }
+        return value;
+    }
+
+    // cpu lists look like "0-3,8-11".
+    std::vector<size_t> parseCpuList(const std::string& text) {
+        std::vector<size_t> ids;
+        std::istringstream in(text);
+        for (std::string range; std::getline(in, range, ',');) {
+            if (range.empty()) continue;
+            const size_t dash = range.find('-');
+            const size_t first = std::stoul(range.substr(0, dash));
+            const size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+            for (size_t id = first; id <= last; ++id) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    void queryLinuxTopology(MachineInfo& info) {
+        const std::string cpuRoot = "/sys/devices/system/cpu/";
+        const std::string nodeRoot = "/sys/devices/system/node/";
+
+        std::string online;
+        std::vector<size_t> ids;
+        if (readLine(cpuRoot + "online", online)) ids = parseCpuList(online);
+        if (ids.empty()) {
+            for (size_t cpu = 0; cpu < info.logicalCores; ++cpu) ids.push_back(cpu);
+        }
+
+        std::map<size_t, size_t> nodeOf;
+        std::string nodes;
+        if (readLine(nodeRoot + "online", nodes)) {
+            const auto nodeIds = parseCpuList(nodes);
+            for (const size_t node : nodeIds) {
+                std::string list;
+                if (!readLine(nodeRoot + "node" + std::to_string(node) + "/cpulist", list)) continue;
+                for (const size_t cpu : parseCpuList(list)) nodeOf[cpu] = node;
+            }
+            info.numaNodes = std::max<size_t>(nodeIds.size(), 1);
+        }
+
+        std::map<std::pair<size_t, size_t>, size_t> coreIndex;
+        for (const size_t id : ids) {
+            const std::string topology = cpuRoot + "cpu" + std::to_string(id) + "/topology/";
+            std::string package = "0", core = std::to_string(id);
+            readLine(topology + "physical_package_id", package);
+            readLine(topology + "core_id", core);
+
+            LogicalCpu cpu;
+            cpu.id = id;
+            cpu.package = std::stoul(package);
+            const auto key = std::make_pair(cpu.package, static_cast<size_t>(std::stoul(core)));
+            cpu.core = coreIndex.emplace(key, coreIndex.size()).first->second;
+            cpu.node = nodeOf.count(id) ? nodeOf[id] : 0;
+            info.cpus.push_back(cpu);
+        }
+        if (!coreIndex.empty()) info.physicalCores = coreIndex.size();
+    }
+
+    void queryLinux(MachineInfo& info) {
+        const std::string cpuRoot = "/sys/devices/system/cpu/";
+
+        for (size_t index = 0;; ++index) {
+            const std::string cacheDir = cpuRoot + "cpu0/cache/index" + std::to_string(index) + "/";
+            std::string level, type, size;
+            if (!readLine(cacheDir + "level", level) || !readLine(cacheDir + "type", type) || !readLine(cacheDir + "size", size)) break;
+            if (type == "Instruction") continue;
+
+            const size_t bytes = parseSize(size);
+            if (bytes == 0) continue;
+            if (level == "1") info.l1dBytes = bytes;
+            else if (level == "2") info.l2Bytes = bytes;
+            else if (level == "3") info.l3Bytes = bytes;
+        }
+
+        queryLinuxTopology(info);
+
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        for (std::string line; std::getline(cpuinfo, line);) {
+            if (line.rfind("model name", 0) == 0) {
+                const size_t colon = line.find(':');
+                if (colon != std::string::npos) info.cpuModel = line.substr(line.find_first_not_of(' ', colon + 1));
+                break;
+            }
+        }
+    }
+#else
+    void queryWindows(MachineInfo& info) {
+        DWORD bytes = 0;
+        GetLogicalProcessorInformation(nullptr, &bytes);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> entries(bytes / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (!GetLogicalProcessorInformation(entries.data(), &bytes)) return;
+
+        // processor group 0 only, which is all SetThreadAffinityMask can address.
+        std::map<size_t, LogicalCpu> cpus;
+        size_t physical = 0;
+        for (const auto& entry : entries) {
+            if (entry.Relationship == RelationProcessorCore) {
+                for (size_t bit = 0; bit < sizeof(ULONG_PTR) * 8; ++bit) {
+                    if (entry.ProcessorMask & (ULONG_PTR{1} << bit)) {
+                        cpus[bit].id = bit;
+                        cpus[bit].core = physical;
+                    }
+                }
+                ++physical;
+            } else if (entry.Relationship == RelationNumaNode) {
+                for (size_t bit = 0; bit < sizeof(ULONG_PTR) * 8; ++bit) {
+                    if (entry.ProcessorMask & (ULONG_PTR{1} << bit)) {
+                        cpus[bit].node = entry.NumaNode.NodeNumber;
+                    }
+                }
+                info.numaNodes = std::max<size_t>(info.numaNodes, entry.NumaNode.NodeNumber + 1);
+            } else if (entry.Relationship == RelationCache && entry.Cache.Type != CacheInstruction) {
+                switch (entry.Cache.Level) {
+                    case 1: info.l1dBytes = entry.Cache.Size; break;
+                    case 2: info.l2Bytes  = entry.Cache.Size; break;
+                    case 3: info.l3Bytes  = entry.Cache.Size; break;
+                    default: break;
+                }
+            }
+        }
+        if (physical != 0) info.physicalCores = physical;
+        for (const auto& [id, cpu] : cpus) {
+            info.cpus.push_back(cpu);
+        }
+
+        char model[256] = {};
+        DWORD size = sizeof(model);
+        if (RegGetValueA(HKEY_LOCAL_MACHINE, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", "ProcessorNameString",
+                         RRF_RT_REG_SZ, nullptr, model, &size) == ERROR_SUCCESS) {
+            info.cpuModel = model;
+        }
+    }
+#endif
+
+    MachineInfo queryMachineInfo() {
+        MachineInfo info;
+        info.logicalCores = std::max(1u, std::thread::hardware_concurrency());
+        info.physicalCores = info.logicalCores;
+#if defined(_WIN32)
+        queryWindows(info);
+#else
+        queryLinux(info);
+#endif
+        if (info.cpuModel.empty()) info.cpuModel = "unknown";
+        if (info.cpus.empty()) {
+            for (size_t id = 0; id < info.logicalCores; ++id) {
+                info.cpus.push_back({id, 0, id, 0});
+            }
+        }
+        return info;
+    }
+}
+
+std::string MachineInfo::id() const {
+    std::ostringstream oss;
+    oss << cpuModel << "_" << logicalCores << "t_" << physicalCores << "c_" << (l1dBytes >> 10) << "K_" << (l2Bytes >> 10) << "K_" << (l3Bytes >> 10) << "K";
+    std::string result = oss.str();
+    std::replace_if(result.begin(), result.end(), [](const char c) { return c == ' ' || c == '\t'; }, '_');
+    return result;
+}
+
+const MachineInfo& machineInfo() {
+    static const MachineInfo info = queryMachineInfo();
+    return info;
+}
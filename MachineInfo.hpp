@@ -0,0 +1,38 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_MACHINEINFO_HPP
+#define CUDAHISTOGRAMS_MACHINEINFO_HPP
+
+#include <string>
+#include <vector>
+
+// one online logical CPU. core is an index over the machine's physical cores, so SMT siblings share it.
+struct LogicalCpu {
+    size_t id = 0;       // OS cpu number, what affinity masks take
+    size_t package = 0;
+    size_t core = 0;
+    size_t node = 0;     // NUMA node
+};
+
+// cache sizes are per core (L1D/L2) or per package (L3), falling back to common values when the OS won't say.
+struct MachineInfo {
+    std::string cpuModel;
+    size_t logicalCores = 1;
+    size_t physicalCores = 1;
+    size_t l1dBytes = 32 * 1024;
+    size_t l2Bytes = 1024 * 1024;
+    size_t l3Bytes = 32 * 1024 * 1024;
+    size_t numaNodes = 1;
+    std::vector<LogicalCpu> cpus; // sorted by id
+
+    // stable identifier of this machine for cached tuning results, no whitespace.
+    std::string id() const;
+};
+
+// sysfs (/sys/devices/system/cpu, /sys/devices/system/node) and /proc/cpuinfo on Linux, GetLogicalProcessorInformation on Windows.
+// Queried once.
+const MachineInfo& machineInfo();
+
+#endif //CUDAHISTOGRAMS_MACHINEINFO_HPP
@@ -0,0 +1,159 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "MappedInput.hpp"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedInputFile::MappedInputFile(const std::string& path, const ElementWidth width) : width(width) {
+#if defined(_WIN32)
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open " + path);
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    bytes = static_cast<size_t>(fileSize.QuadPart);
+    if (bytes != 0) {
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        base = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    }
+#else
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + path);
+    }
+    struct stat st{};
+    fstat(fd, &st);
+    bytes = static_cast<size_t>(st.st_size);
+    if (bytes != 0) {
+        base = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) base = nullptr;
+    }
+#endif
+    mappedBytes = bytes;
+    if (bytes != 0 && base == nullptr) {
+        unmap();
+        throw std::runtime_error("Could not map " + path);
+    }
+    // a trailing partial element is ignored.
+    bytes -= bytes % static_cast<size_t>(width);
+}
+
+MappedInputFile::~MappedInputFile() {
+    unmap();
+}
+
+void MappedInputFile::unmap() {
+#if defined(_WIN32)
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle && fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    if (base) munmap(base, mappedBytes);
+    if (fd >= 0) close(fd);
+    fd = -1;
+#endif
+    base = nullptr;
+}
+
+std::vector<MappedRange> MappedInputFile::ranges(const size_t threadAmount) const {
+    const size_t pageSize = systemPageSize();
+    const size_t elementSize = static_cast<size_t>(width);
+    const size_t bytesPerThread = ((bytes + threadAmount - 1) / threadAmount + pageSize - 1) & ~(pageSize - 1);
+
+    std::vector<MappedRange> result(threadAmount);
+    for (size_t t = 0; t < threadAmount; ++t) {
+        const size_t beginByte = std::min(t * bytesPerThread, bytes);
+        const size_t endByte   = std::min(beginByte + bytesPerThread, bytes);
+        result[t] = {beginByte / elementSize, endByte / elementSize};
+    }
+    return result;
+}
+
+void MappedInputFile::adviseSequential() const {
+#if !defined(_WIN32)
+    if (base) madvise(base, bytes, MADV_SEQUENTIAL);
+#endif
+}
+
+void MappedInputFile::willNeed(const size_t begin, const size_t end) const {
+    if (!base || begin >= end) return;
+
+    const size_t pageSize = systemPageSize();
+    const size_t elementSize = static_cast<size_t>(width);
+    const size_t beginByte = (begin * elementSize) & ~(pageSize - 1);
+    const size_t endByte   = end * elementSize;
+    char* start = static_cast<char*>(base) + beginByte;
+#if defined(_WIN32)
+    WIN32_MEMORY_RANGE_ENTRY entry{start, endByte - beginByte};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+#else
+    madvise(start, endByte - beginByte, MADV_WILLNEED);
+#endif
+}
+
+void MappedInputFile::release(const size_t begin, const size_t end) const {
+    if (!base || begin >= end) return;
+
+    // only whole pages inside the range, a neighbouring range may still be reading the edges.
+    const size_t pageSize = systemPageSize();
+    const size_t elementSize = static_cast<size_t>(width);
+    const size_t beginByte = (begin * elementSize + pageSize - 1) & ~(pageSize - 1);
+    const size_t endByte   = end * elementSize == bytes ? bytes : (end * elementSize) & ~(pageSize - 1);
+    if (beginByte >= endByte) return;
+    char* start = static_cast<char*>(base) + beginByte;
+#if defined(_WIN32)
+    // file backed views can't be discarded, unlocking at least lets the working set trimmer take them.
+    VirtualUnlock(start, endByte - beginByte);
+#else
+    madvise(start, endByte - beginByte, MADV_DONTNEED);
+#endif
+}
+
+std::shared_ptr<int[]> mappedIntArray(const std::shared_ptr<MappedInputFile>& file) {
+    // aliasing constructor, no copy and no deleter of its own.
+    return std::shared_ptr<int[]>(file, const_cast<int*>(file->data<int>()));
+}
+
+void profile_mapped_cpu_histogram(const MappedInputFile& file, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                  const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int);
+    const std::shared_ptr<int[]> reducedHistogram = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+
+    const auto solve = [&]() {
+        switch (file.elementWidth()) {
+            case ElementWidth::U8:
+                solveMappedHistogram<uint8_t>(file, testHistogram, reducedHistogram, maxVal, threadAmount, perThreadInts, true, pool);
+                break;
+            case ElementWidth::U16:
+                solveMappedHistogram<uint16_t>(file, testHistogram, reducedHistogram, maxVal, threadAmount, perThreadInts, true, pool);
+                break;
+            case ElementWidth::I32:
+                solveMappedHistogram<int32_t>(file, testHistogram, reducedHistogram, maxVal, threadAmount, perThreadInts, true, pool);
+                break;
+        }
+    };
+
+    // warmup, the truth pass already paged the file in, so every timed iteration reads it from the page cache.
+    solve();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), file.size(), threadAmount);
+        solve();
+        TIMING_END(testName, static_cast<size_t>(maxVal), file.size(), threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
@@ -0,0 +1,121 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_MAPPEDINPUT_HPP
+#define CUDAHISTOGRAMS_MAPPEDINPUT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+// bytes per element of a raw little endian input file.
+enum class ElementWidth : size_t {
+    U8  = 1,
+    U16 = 2,
+    I32 = 4
+};
+
+// bytes a worker consumes between read-ahead/release hints.
+constexpr size_t MAPPED_WINDOW_BYTES = 64ull << 20;
+
+struct MappedRange {
+    size_t begin; // element index, begin * width is page aligned
+    size_t end;
+};
+
+// read only, zero copy view of a raw binary file. Pages are brought in with read-ahead hints and can be
+// dropped again once a range has been consumed, so inputs larger than RAM stream through the page cache.
+class MappedInputFile {
+    void* base = nullptr;
+    size_t bytes = 0;
+    size_t mappedBytes = 0;
+    ElementWidth width;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    void unmap();
+
+public:
+    MappedInputFile(const std::string& path, ElementWidth width);
+    ~MappedInputFile();
+
+    MappedInputFile(const MappedInputFile&) = delete;
+    MappedInputFile& operator=(const MappedInputFile&) = delete;
+
+    template<typename T>
+    const T* data() const { return static_cast<const T*>(base); }
+
+    size_t size() const { return bytes / static_cast<size_t>(width); }
+    size_t sizeBytes() const { return bytes; }
+    ElementWidth elementWidth() const { return width; }
+
+    // splits the file into threadAmount ranges whose first byte sits on a page boundary.
+    std::vector<MappedRange> ranges(size_t threadAmount) const;
+
+    // MADV_SEQUENTIAL over the whole mapping.
+    void adviseSequential() const;
+    // MADV_WILLNEED, kicks off read-ahead for [begin, end) elements.
+    void willNeed(size_t begin, size_t end) const;
+    // MADV_DONTNEED, drops the pages fully inside [begin, end) elements.
+    void release(size_t begin, size_t end) const;
+};
+
+// int32 files can be handed to the existing solvers directly, the returned pointer keeps the mapping alive.
+std::shared_ptr<int[]> mappedIntArray(const std::shared_ptr<MappedInputFile>& file);
+
+// reduced solver reading straight from the mapping: every thread walks its page aligned range in
+// MAPPED_WINDOW_BYTES windows, prefetching the next window and releasing the consumed one.
+template<typename T>
+void solveMappedHistogram(const MappedInputFile& file, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& reducedHistogram,
+    const size_t maxVal, const size_t threadAmount, const size_t perThreadInts, const bool releaseConsumed, ThreadPool& pool) {
+    const T* data = file.data<T>();
+    const std::vector<MappedRange> ranges = file.ranges(threadAmount);
+    constexpr size_t windowElements = MAPPED_WINDOW_BYTES / sizeof(T);
+
+    file.adviseSequential();
+
+    std::vector<std::future<void>> futures;
+    for (size_t t = 0; t < threadAmount; ++t) {
+        futures.push_back(pool.queue([=, &file, &reducedHistogram]() {
+            int* hist = reducedHistogram.get() + t * perThreadInts;
+            std::fill_n(hist, maxVal, 0);
+
+            const MappedRange range = ranges[t];
+            for (size_t begin = range.begin; begin < range.end; begin += windowElements) {
+                const size_t end = std::min(begin + windowElements, range.end);
+                if (end < range.end) {
+                    file.willNeed(end, std::min(end + windowElements, range.end));
+                }
+                for (size_t i = begin; i < end; ++i) {
+                    ++hist[data[i]];
+                }
+                if (releaseConsumed) {
+                    file.release(begin, end);
+                }
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    reduceBinSliced(reducedHistogram.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+}
+
+void profile_mapped_cpu_histogram(const MappedInputFile& file, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                  int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_MAPPEDINPUT_HPP
@@ -0,0 +1,187 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "PackedInput.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <immintrin.h>
+#include <limits>
+#include <stdexcept>
+
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+namespace {
+    void countPackedScalar(const uint8_t* bytes, const unsigned bits, const size_t begin, const size_t end, int* hist) {
+        const uint64_t mask = (1ULL << bits) - 1;
+        size_t bit = begin * bits;
+        for (size_t i = begin; i < end; ++i, bit += bits) {
+            uint64_t word;
+            std::memcpy(&word, bytes + (bit >> 3), sizeof(word));
+            ++hist[(word >> (bit & 7)) & mask];
+        }
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    void countPackedAvx512(const uint8_t* bytes, const unsigned bits, const size_t begin, const size_t end, int* hist) {
+        const __m512i mask = _mm512_set1_epi64(static_cast<int64_t>((1ULL << bits) - 1));
+        const __m512i seven = _mm512_set1_epi64(7);
+        const __m512i step = _mm512_set1_epi64(static_cast<int64_t>(8 * bits));
+        const auto first = static_cast<int64_t>(begin * bits);
+        const auto b = static_cast<int64_t>(bits);
+        __m512i bitOffsets = _mm512_setr_epi64(first, first + b, first + 2 * b, first + 3 * b, first + 4 * b, first + 5 * b, first + 6 * b, first + 7 * b);
+        alignas(32) uint32_t values[8];
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            const __m512i words = _mm512_i64gather_epi64(_mm512_srli_epi64(bitOffsets, 3), bytes, 1);
+            const __m512i unpacked = _mm512_and_si512(_mm512_srlv_epi64(words, _mm512_and_si512(bitOffsets, seven)), mask);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(values), _mm512_cvtepi64_epi32(unpacked));
+            bitOffsets = _mm512_add_epi64(bitOffsets, step);
+            ++hist[values[0]];
+            ++hist[values[1]];
+            ++hist[values[2]];
+            ++hist[values[3]];
+            ++hist[values[4]];
+            ++hist[values[5]];
+            ++hist[values[6]];
+            ++hist[values[7]];
+        }
+        countPackedScalar(bytes, bits, i, end, hist);
+    }
+}
+
+PackedArray::PackedArray(const int* data, const size_t count, const unsigned bits)
+    : count(count), bitWidth(bits), words((count * bits + 63) / 64 + 1, 0) {
+    if (bits == 0 || bits > 31) throw std::invalid_argument("PackedArray packs 1 to 31 bit values");
+    for (size_t i = 0; i < count; ++i) {
+        const auto value = static_cast<uint64_t>(static_cast<uint32_t>(data[i]));
+        if (data[i] < 0 || value >> bits != 0) {
+            throw std::invalid_argument("value " + std::to_string(data[i]) + " does not fit " + std::to_string(bits) + " bits");
+        }
+        const size_t bit = i * bits;
+        words[bit / 64] |= value << (bit % 64);
+        if (bit % 64 + bits > 64) {
+            words[bit / 64 + 1] |= value >> (64 - bit % 64);
+        }
+    }
+}
+
+unsigned PackedArray::bitsFor(const size_t maxVal) {
+    return std::max(1u, static_cast<unsigned>(std::bit_width(maxVal > 0 ? maxVal - 1 : 0)));
+}
+
+RunLengthArray::RunLengthArray(const int* data, const size_t count, const unsigned bits) : count(count) {
+    std::vector<int> runValues;
+    for (size_t i = 0; i < count;) {
+        size_t j = i + 1;
+        while (j < count && data[j] == data[i] && j - i < std::numeric_limits<uint32_t>::max()) {
+            ++j;
+        }
+        runValues.push_back(data[i]);
+        lengths.push_back(static_cast<uint32_t>(j - i));
+        i = j;
+    }
+    values = PackedArray(runValues.data(), runValues.size(), bits);
+}
+
+const char* inputEncodingName(const InputEncoding encoding) {
+    return encoding == InputEncoding::Packed ? "packed" : "run length";
+}
+
+size_t countRuns(const int* data, const size_t dataSize) {
+    size_t runs = dataSize > 0;
+    for (size_t i = 1; i < dataSize; ++i) {
+        runs += data[i] != data[i - 1];
+    }
+    return runs;
+}
+
+InputEncoding selectInputEncoding(const size_t dataSize, const size_t runs, const unsigned bits) {
+    const size_t packedBytes = (dataSize * bits + 7) / 8;
+    const size_t runLengthBytes = (runs * bits + 7) / 8 + runs * sizeof(uint32_t);
+    return runLengthBytes < packedBytes ? InputEncoding::RunLength : InputEncoding::Packed;
+}
+
+void countPacked(const SimdLevel level, const PackedArray& input, const size_t begin, const size_t end, int* hist) {
+    if (level == SimdLevel::AVX512) {
+        countPackedAvx512(input.bytes(), input.bits(), begin, end, hist);
+    } else {
+        countPackedScalar(input.bytes(), input.bits(), begin, end, hist);
+    }
+}
+
+void solveThreadedPackedHistogram(const PackedArray& input, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    const size_t maxVal, const size_t threadAmount, const size_t perThreadInts, const SimdLevel level, ThreadPool& pool) {
+    const size_t dataSize = input.size();
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &input, &privateHistograms](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        countPacked(level, input, start, end, privateHistograms.get() + t * perThreadInts);
+    }).wait();
+
+    reduceBinSliced<true>(privateHistograms.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+}
+
+void solveThreadedRunLengthHistogram(const RunLengthArray& input, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    const size_t maxVal, const size_t threadAmount, const size_t perThreadInts, ThreadPool& pool) {
+    const size_t runs = input.runs();
+    const size_t runsPerThread = (runs + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &input, &privateHistograms](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        int* hist = privateHistograms.get() + t * perThreadInts;
+        const PackedArray& values = input.runValues();
+        const uint32_t* lengths = input.runLengths();
+        const size_t start = std::min(t * runsPerThread, runs);
+        const size_t end   = std::min(start + runsPerThread, runs);
+        for (size_t r = start; r < end; ++r) {
+            hist[values[r]] += static_cast<int>(lengths[r]);
+        }
+    }).wait();
+
+    reduceBinSliced<true>(privateHistograms.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+}
+
+void profile_threaded_packed_cpu_histogram(const PackedArray& input, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool,
+                                           const SimdLevel level) {
+    const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int);
+    const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+
+    // warmup
+    solveThreadedPackedHistogram(input, testHistogram, privateHistograms, maxVal, threadAmount, perThreadInts, level, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), input.size(), threadAmount);
+        solveThreadedPackedHistogram(input, testHistogram, privateHistograms, maxVal, threadAmount, perThreadInts, level, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), input.size(), threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
+
+void profile_threaded_run_length_cpu_histogram(const RunLengthArray& input, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                               const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int);
+    const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+
+    // warmup
+    solveThreadedRunLengthHistogram(input, testHistogram, privateHistograms, maxVal, threadAmount, perThreadInts, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), input.size(), threadAmount);
+        solveThreadedRunLengthHistogram(input, testHistogram, privateHistograms, maxVal, threadAmount, perThreadInts, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), input.size(), threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
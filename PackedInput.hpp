@@ -0,0 +1,100 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_PACKEDINPUT_HPP
+#define CUDAHISTOGRAMS_PACKEDINPUT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+
+// Values bit packed LSB first into one contiguous bit stream, value i at bits [i * bits, (i + 1) * bits).
+// Any value is one unaligned 64 bit load, shift and mask away (bits <= 31), so threads can start anywhere
+// and nothing ever gets unpacked into a temporary array. The storage carries a spare word so that load is
+// always in bounds.
+class PackedArray {
+    size_t count = 0;
+    unsigned bitWidth = 1;
+    std::vector<uint64_t> words;
+
+public:
+    PackedArray() = default;
+    // throws std::invalid_argument if a value is negative or needs more than bits bits.
+    PackedArray(const int* data, size_t count, unsigned bits);
+
+    // smallest width that holds [0, maxVal).
+    static unsigned bitsFor(size_t maxVal);
+
+    size_t size() const { return count; }
+    unsigned bits() const { return bitWidth; }
+    size_t sizeBytes() const { return (count * bitWidth + 7) / 8; }
+    const uint8_t* bytes() const { return reinterpret_cast<const uint8_t*>(words.data()); }
+
+    uint32_t operator[](const size_t i) const {
+        const size_t bit = i * bitWidth;
+        uint64_t word;
+        std::memcpy(&word, bytes() + (bit >> 3), sizeof(word));
+        return static_cast<uint32_t>((word >> (bit & 7)) & ((1ULL << bitWidth) - 1));
+    }
+};
+
+// (value, length) runs of equal consecutive values, values bit packed like PackedArray. Pays off for
+// clustered or sorted data where runs are much longer than the 4 byte length.
+class RunLengthArray {
+    size_t count = 0;
+    PackedArray values;
+    std::vector<uint32_t> lengths;
+
+public:
+    RunLengthArray() = default;
+    RunLengthArray(const int* data, size_t count, unsigned bits);
+
+    size_t size() const { return count; }
+    size_t runs() const { return lengths.size(); }
+    size_t sizeBytes() const { return values.sizeBytes() + lengths.size() * sizeof(uint32_t); }
+    const PackedArray& runValues() const { return values; }
+    const uint32_t* runLengths() const { return lengths.data(); }
+};
+
+enum class InputEncoding {
+    Packed,
+    RunLength
+};
+
+const char* inputEncodingName(InputEncoding encoding);
+
+// runs of equal consecutive values in data.
+size_t countRuns(const int* data, size_t dataSize);
+
+// run length once its runs take fewer bytes than the packed values.
+InputEncoding selectInputEncoding(size_t dataSize, size_t runs, unsigned bits);
+
+// counts input[begin, end) into hist, unpacking in registers. AVX-512 gathers 8 unaligned words at once and
+// shifts/masks them as a vector; the increments stay scalar like every other private histogram loop.
+void countPacked(SimdLevel level, const PackedArray& input, size_t begin, size_t end, int* hist);
+
+// privateHistograms holds threadAmount * perThreadInts ints, zero on entry and zeroed again by the reduction.
+void solveThreadedPackedHistogram(const PackedArray& input, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    size_t maxVal, size_t threadAmount, size_t perThreadInts, SimdLevel level, ThreadPool& pool);
+
+// threads split the runs, every run is credited as hist[value] += length.
+void solveThreadedRunLengthHistogram(const RunLengthArray& input, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    size_t maxVal, size_t threadAmount, size_t perThreadInts, ThreadPool& pool);
+
+// both keep the default int element size for the results, so GB/s is the effective bandwidth of the int
+// layout and compares directly with the int solvers.
+void profile_threaded_packed_cpu_histogram(const PackedArray& input, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool,
+                                           SimdLevel level = detectSimdLevel());
+
+void profile_threaded_run_length_cpu_histogram(const RunLengthArray& input, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                               int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_PACKEDINPUT_HPP
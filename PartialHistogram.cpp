@@ -0,0 +1,247 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "PartialHistogram.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t HEADER_BYTES = 56;
+    constexpr size_t CHECKSUM_BYTES = 4;
+
+    uint32_t fnv1a(const uint8_t* bytes, const size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    template<typename T>
+    void put(std::vector<uint8_t>& out, const T value) {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // bounds checked reads over the received bytes.
+    class Reader {
+        const uint8_t* bytes;
+        size_t size;
+        size_t offset = 0;
+
+    public:
+        Reader(const uint8_t* bytes, const size_t size) : bytes(bytes), size(size) {}
+
+        template<typename T>
+        T get() {
+            if (size - offset < sizeof(T)) throw std::runtime_error("truncated partial histogram");
+            T value;
+            std::memcpy(&value, bytes + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        uint64_t getVarint() {
+            uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                const auto byte = get<uint8_t>();
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) return value;
+            }
+            throw std::runtime_error("malformed varint in partial histogram");
+        }
+
+        size_t remaining() const { return size - offset; }
+    };
+
+    size_t serializedBytes(const PartialHistogram& partial) {
+        // close enough for choosing a form: dense at 4 bytes a count, sparse at ~2 bytes of key delta plus the count.
+        if (partial.kind() == PartialKind::Dense) return partial.bins() * sizeof(uint32_t);
+        return partial.entries() * 6;
+    }
+}
+
+PartialHistogram PartialHistogram::dense(const int* histogram, const size_t bins, const uint64_t elements, const BinMetadata& metadata) {
+    return dense(std::vector<int64_t>(histogram, histogram + bins), elements, metadata);
+}
+
+PartialHistogram PartialHistogram::dense(std::vector<int64_t> counts, const uint64_t elements, const BinMetadata& metadata) {
+    PartialHistogram partial;
+    partial.partialKind = PartialKind::Dense;
+    partial.binCount = counts.size();
+    partial.elementCount = elements;
+    partial.meta = metadata;
+    partial.denseCounts = std::move(counts);
+    return partial;
+}
+
+PartialHistogram PartialHistogram::sparse(const SparseHistogram& histogram, const size_t bins, const uint64_t elements, const BinMetadata& metadata) {
+    PartialHistogram partial;
+    partial.partialKind = PartialKind::Sparse;
+    partial.binCount = bins;
+    partial.elementCount = elements;
+    partial.meta = metadata;
+    partial.sparseEntries.reserve(histogram.size());
+    histogram.forEach([&](const uint32_t key, const int count) {
+        if (key >= bins) throw std::out_of_range("sparse key " + std::to_string(key) + " outside the partial histogram");
+        partial.sparseEntries.emplace_back(key, count);
+    });
+    std::sort(partial.sparseEntries.begin(), partial.sparseEntries.end());
+    return partial;
+}
+
+PartialHistogram PartialHistogram::compact() const {
+    if (partialKind == PartialKind::Sparse) return *this;
+    PartialHistogram partial;
+    partial.partialKind = PartialKind::Sparse;
+    partial.binCount = binCount;
+    partial.elementCount = elementCount;
+    partial.meta = meta;
+    for (size_t b = 0; b < binCount; ++b) {
+        if (denseCounts[b] != 0) {
+            partial.sparseEntries.emplace_back(static_cast<uint32_t>(b), denseCounts[b]);
+        }
+    }
+    return serializedBytes(partial) < serializedBytes(*this) ? partial : *this;
+}
+
+int64_t PartialHistogram::count(const size_t bin) const {
+    if (partialKind == PartialKind::Dense) return denseCounts[bin];
+    const auto it = std::lower_bound(sparseEntries.begin(), sparseEntries.end(), std::pair<uint32_t, int64_t>(static_cast<uint32_t>(bin), std::numeric_limits<int64_t>::min()));
+    return it != sparseEntries.end() && it->first == bin ? it->second : 0;
+}
+
+void PartialHistogram::addTo(int64_t* histogram, const size_t begin, const size_t end) const {
+    if (partialKind == PartialKind::Dense) {
+        for (size_t b = begin; b < end; ++b) {
+            histogram[b] += denseCounts[b];
+        }
+        return;
+    }
+    auto it = std::lower_bound(sparseEntries.begin(), sparseEntries.end(), std::pair<uint32_t, int64_t>(static_cast<uint32_t>(begin), std::numeric_limits<int64_t>::min()));
+    for (; it != sparseEntries.end() && it->first < end; ++it) {
+        histogram[it->first] += it->second;
+    }
+}
+
+std::vector<uint8_t> PartialHistogram::serialize() const {
+    const bool wide = partialKind == PartialKind::Dense &&
+        std::any_of(denseCounts.begin(), denseCounts.end(), [](const int64_t c) { return c < 0 || c > std::numeric_limits<uint32_t>::max(); });
+
+    std::vector<uint8_t> out;
+    out.reserve(HEADER_BYTES + (partialKind == PartialKind::Dense ? binCount * (wide ? 8 : 4) : sparseEntries.size() * 6) + CHECKSUM_BYTES);
+    put<uint32_t>(out, PARTIAL_MAGIC);
+    put<uint16_t>(out, PARTIAL_VERSION);
+    put<uint8_t>(out, static_cast<uint8_t>(partialKind));
+    put<uint8_t>(out, partialKind == PartialKind::Dense ? (wide ? 8 : 4) : 0);
+    put<uint64_t>(out, binCount);
+    put<uint64_t>(out, elementCount);
+    put<double>(out, meta.lo);
+    put<double>(out, meta.hi);
+    put<uint8_t>(out, meta.outOfRangeBins ? 1 : 0);
+    out.resize(out.size() + 7, 0);
+    put<uint64_t>(out, entries());
+
+    if (partialKind == PartialKind::Dense) {
+        for (const int64_t c : denseCounts) {
+            if (wide) put<int64_t>(out, c);
+            else put<uint32_t>(out, static_cast<uint32_t>(c));
+        }
+    } else {
+        uint32_t previous = 0;
+        for (const auto& [key, c] : sparseEntries) {
+            putVarint(out, key - previous);
+            putVarint(out, static_cast<uint64_t>(c));
+            previous = key;
+        }
+    }
+    put<uint32_t>(out, fnv1a(out.data(), out.size()));
+    return out;
+}
+
+PartialHistogram PartialHistogram::deserialize(const uint8_t* bytes, const size_t size) {
+    if (size < HEADER_BYTES + CHECKSUM_BYTES) throw std::runtime_error("truncated partial histogram");
+    uint32_t checksum;
+    std::memcpy(&checksum, bytes + size - CHECKSUM_BYTES, sizeof(checksum));
+    Reader in(bytes, size - CHECKSUM_BYTES);
+    if (in.get<uint32_t>() != PARTIAL_MAGIC) throw std::runtime_error("not a partial histogram");
+    if (const auto version = in.get<uint16_t>(); version == 0 || version > PARTIAL_VERSION) {
+        throw std::runtime_error("unsupported partial histogram version " + std::to_string(version));
+    }
+    if (fnv1a(bytes, size - CHECKSUM_BYTES) != checksum) throw std::runtime_error("partial histogram checksum mismatch");
+
+    PartialHistogram partial;
+    const auto kind = in.get<uint8_t>();
+    const auto countWidth = in.get<uint8_t>();
+    partial.binCount = in.get<uint64_t>();
+    partial.elementCount = in.get<uint64_t>();
+    partial.meta.lo = in.get<double>();
+    partial.meta.hi = in.get<double>();
+    partial.meta.outOfRangeBins = (in.get<uint8_t>() & 1) != 0;
+    for (int i = 0; i < 7; ++i) in.get<uint8_t>();
+    const auto entries = in.get<uint64_t>();
+
+    if (kind == static_cast<uint8_t>(PartialKind::Dense)) {
+        if ((countWidth != 4 && countWidth != 8) || entries != partial.binCount || in.remaining() != entries * countWidth) {
+            throw std::runtime_error("malformed dense partial histogram");
+        }
+        partial.partialKind = PartialKind::Dense;
+        partial.denseCounts.resize(partial.binCount);
+        for (int64_t& c : partial.denseCounts) {
+            c = countWidth == 8 ? in.get<int64_t>() : static_cast<int64_t>(in.get<uint32_t>());
+        }
+    } else if (kind == static_cast<uint8_t>(PartialKind::Sparse)) {
+        partial.partialKind = PartialKind::Sparse;
+        partial.sparseEntries.reserve(std::min<uint64_t>(entries, in.remaining() / 2));
+        uint64_t key = 0;
+        for (uint64_t e = 0; e < entries; ++e) {
+            key += in.getVarint();
+            if (key >= partial.binCount) throw std::runtime_error("sparse partial histogram key outside its bins");
+            partial.sparseEntries.emplace_back(static_cast<uint32_t>(key), static_cast<int64_t>(in.getVarint()));
+        }
+        if (in.remaining() != 0) throw std::runtime_error("malformed sparse partial histogram");
+    } else {
+        throw std::runtime_error("unknown partial histogram kind");
+    }
+    return partial;
+}
+
+PartialHistogram mergePartialHistograms(const std::vector<PartialHistogram>& partials, ThreadPool& pool) {
+    if (partials.empty()) return {};
+    const size_t bins = partials.front().bins();
+    const BinMetadata& metadata = partials.front().metadata();
+    uint64_t elements = 0;
+    for (const PartialHistogram& partial : partials) {
+        if (partial.bins() != bins || !(partial.metadata() == metadata)) {
+            throw std::invalid_argument("partial histograms with different bins do not merge");
+        }
+        elements += partial.elements();
+    }
+
+    std::vector<int64_t> merged(bins, 0);
+    const size_t threadAmount = pool.size();
+    constexpr size_t binsPerCacheLine = std::hardware_destructive_interference_size / sizeof(int64_t);
+    const size_t binsPerThread = ((bins + threadAmount - 1) / threadAmount + binsPerCacheLine - 1) / binsPerCacheLine * binsPerCacheLine;
+    pool.parallel_for(0, threadAmount, 1, [&, binsPerThread](const size_t t) {
+        const size_t begin = std::min(t * binsPerThread, bins);
+        const size_t end   = std::min(begin + binsPerThread, bins);
+        for (const PartialHistogram& partial : partials) {
+            partial.addTo(merged.data(), begin, end);
+        }
+    }).wait();
+
+    return PartialHistogram::dense(std::move(merged), elements, metadata);
+}
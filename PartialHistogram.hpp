@@ -0,0 +1,82 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_PARTIALHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_PARTIALHISTOGRAM_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "SparseHistogram.hpp"
+#include "ThreadPool.hpp"
+
+constexpr uint32_t PARTIAL_MAGIC = 0x54525048; // "HPRT" little endian
+constexpr uint16_t PARTIAL_VERSION = 1;
+
+// what the bins mean, partials only merge when it matches. Identity bins cover the values [0, bins).
+struct BinMetadata {
+    double lo = 0.0;
+    double hi = 0.0;
+    bool outOfRangeBins = false; // the last two bins are under/overflow, see BinMapper.hpp
+
+    bool operator==(const BinMetadata&) const = default;
+};
+
+inline BinMetadata identityBins(const size_t maxVal) {
+    return {0.0, static_cast<double>(maxVal), false};
+}
+
+enum class PartialKind : uint8_t {
+    Dense = 0,
+    Sparse = 1
+};
+
+// One shard's (or host's) histogram plus what is needed to merge it with others. Serialized little endian:
+//
+//   u32 magic, u16 version, u8 kind, u8 dense count width (4 or 8, 0 for sparse),
+//   u64 bins, u64 elements, f64 lo, f64 hi, u8 flags (bit 0: outOfRangeBins), 7 reserved bytes, u64 entries,
+//   payload, u32 FNV-1a of everything before it.
+//
+// Dense payloads are bins fixed width counts, 4 bytes unless a count needs 8. Sparse payloads are entries
+// (key delta, count) LEB128 varint pairs in key order.
+class PartialHistogram {
+    PartialKind partialKind = PartialKind::Dense;
+    size_t binCount = 0;
+    uint64_t elementCount = 0;
+    BinMetadata meta;
+    std::vector<int64_t> denseCounts;
+    std::vector<std::pair<uint32_t, int64_t>> sparseEntries; // sorted by key
+
+public:
+    PartialHistogram() = default;
+
+    static PartialHistogram dense(const int* histogram, size_t bins, uint64_t elements, const BinMetadata& metadata);
+    static PartialHistogram dense(std::vector<int64_t> counts, uint64_t elements, const BinMetadata& metadata);
+    static PartialHistogram sparse(const SparseHistogram& histogram, size_t bins, uint64_t elements, const BinMetadata& metadata);
+
+    // sparse form when it serializes smaller, roughly under a quarter of the bins set.
+    PartialHistogram compact() const;
+
+    PartialKind kind() const { return partialKind; }
+    size_t bins() const { return binCount; }
+    uint64_t elements() const { return elementCount; }
+    const BinMetadata& metadata() const { return meta; }
+    // non-zero entries for sparse, bins for dense.
+    size_t entries() const { return partialKind == PartialKind::Dense ? binCount : sparseEntries.size(); }
+
+    int64_t count(size_t bin) const;
+    // adds bins [begin, end) into histogram[begin, end).
+    void addTo(int64_t* histogram, size_t begin, size_t end) const;
+
+    std::vector<uint8_t> serialize() const;
+    // throws std::runtime_error on a bad magic, unknown version, checksum mismatch or truncated payload.
+    static PartialHistogram deserialize(const uint8_t* bytes, size_t size);
+};
+
+// bin sliced over the pool: every task sums its slice of bins across all partials (sparse ones through a
+// binary search for the slice start). Throws std::invalid_argument if bins or metadata differ.
+PartialHistogram mergePartialHistograms(const std::vector<PartialHistogram>& partials, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_PARTIALHISTOGRAM_HPP
@@ -0,0 +1,134 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "PartitionedHistogram.hpp"
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+#include "PhaseTrace.hpp"
+
+PartitionLayout planPartitionLayout(const size_t maxVal, const size_t threadAmount, const size_t sliceBytes) {
+    // never split below one cache line of bins, so pass 2 never shares a line between threads.
+    constexpr size_t minShift = 4;
+
+    size_t shift = minShift;
+    while ((size_t{2} << shift) * sizeof(int) <= sliceBytes) {
+        ++shift;
+    }
+    while (shift > minShift && ((maxVal + (size_t{1} << shift) - 1) >> shift) < threadAmount) {
+        --shift;
+    }
+
+    const size_t numBuckets = std::max<size_t>((maxVal + (size_t{1} << shift) - 1) >> shift, 1);
+    constexpr size_t countsPerCacheLine = 64 / sizeof(size_t);
+    return {shift, numBuckets, (numBuckets + countsPerCacheLine - 1) / countsPerCacheLine * countsPerCacheLine};
+}
+
+void solveThreadedPartitionedHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram,
+    const std::shared_ptr<int[]>& partitioned, const std::shared_ptr<size_t[]>& bucketCounts,
+    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const PartitionLayout& layout, ThreadPool& pool) {
+    const size_t shift = layout.bucketShift;
+    const size_t numBuckets = layout.numBuckets;
+    const size_t stride = layout.countStride;
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    std::vector<std::future<void>> futures;
+    const auto waitAll = [&futures]() {
+        for (auto& future : futures) {
+            future.get();
+        }
+        futures.clear();
+    };
+
+    // pass 1a: size every (thread, bucket) run.
+    for (size_t t = 0; t < threadAmount; ++t) {
+        futures.push_back(pool.queue([=, &data, &bucketCounts]() {
+            trace::Scope scope(trace::Phase::Scatter);
+            size_t* counts = bucketCounts.get() + t * stride;
+            std::fill_n(counts, numBuckets, 0);
+
+            const size_t start = std::min(t * elementsPerThread, dataSize);
+            const size_t end   = std::min(start + elementsPerThread, dataSize);
+            for (size_t i = start; i < end; ++i) {
+                ++counts[static_cast<size_t>(data[i]) >> shift];
+            }
+        }));
+    }
+    waitAll();
+
+    // bucket major offsets, so each bucket ends up contiguous in partitioned. Turns the counts into
+    // every thread's write cursor.
+    std::vector<size_t> bucketBegin(numBuckets + 1);
+    size_t offset = 0;
+    for (size_t b = 0; b < numBuckets; ++b) {
+        bucketBegin[b] = offset;
+        for (size_t t = 0; t < threadAmount; ++t) {
+            const size_t count = bucketCounts[t * stride + b];
+            bucketCounts[t * stride + b] = offset;
+            offset += count;
+        }
+    }
+    bucketBegin[numBuckets] = offset;
+
+    // pass 1b: scatter.
+    for (size_t t = 0; t < threadAmount; ++t) {
+        futures.push_back(pool.queue([=, &data, &partitioned, &bucketCounts]() {
+            trace::Scope scope(trace::Phase::Scatter);
+            size_t* cursor = bucketCounts.get() + t * stride;
+            int* out = partitioned.get();
+
+            const size_t start = std::min(t * elementsPerThread, dataSize);
+            const size_t end   = std::min(start + elementsPerThread, dataSize);
+            for (size_t i = start; i < end; ++i) {
+                const int value = data[i];
+                out[cursor[static_cast<size_t>(value) >> shift]++] = value;
+            }
+        }));
+    }
+    waitAll();
+
+    // pass 2: each bucket owns bins [b << shift, (b + 1) << shift) of the output, small enough to stay in L1.
+    const size_t bucketsPerThread = (numBuckets + threadAmount - 1) / threadAmount;
+    for (size_t t = 0; t < threadAmount; ++t) {
+        futures.push_back(pool.queue([=, &histogram, &partitioned, &bucketBegin]() {
+            trace::Scope scope(trace::Phase::Count);
+            int* hist = histogram.get();
+            const int* in = partitioned.get();
+
+            const size_t firstBucket = std::min(t * bucketsPerThread, numBuckets);
+            const size_t lastBucket  = std::min(firstBucket + bucketsPerThread, numBuckets);
+            for (size_t b = firstBucket; b < lastBucket; ++b) {
+                const size_t binBegin = b << shift;
+                const size_t binEnd   = std::min((b + 1) << shift, maxVal);
+                std::fill(hist + binBegin, hist + binEnd, 0);
+
+                for (size_t i = bucketBegin[b]; i < bucketBegin[b + 1]; ++i) {
+                    ++hist[in[i]];
+                }
+            }
+        }));
+    }
+    waitAll();
+}
+
+void profile_threaded_partitioned_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                                const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const PartitionLayout layout = planPartitionLayout(static_cast<size_t>(maxVal), threadAmount);
+
+    const std::shared_ptr<int[]> partitioned = makeAlignedArray<int>(dataSize, systemPageSize());
+    const std::shared_ptr<size_t[]> bucketCounts(new size_t[threadAmount * layout.countStride]);
+
+    // warmup
+    solveThreadedPartitionedHistogram(data, testHistogram, partitioned, bucketCounts, dataSize, maxVal, threadAmount, layout, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveThreadedPartitionedHistogram(data, testHistogram, partitioned, bucketCounts, dataSize, maxVal, threadAmount, layout, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
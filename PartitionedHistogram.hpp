@@ -0,0 +1,36 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_PARTITIONEDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_PARTITIONEDHISTOGRAM_HPP
+
+#include <memory>
+#include <string>
+
+#include "Common.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+
+// bytes of histogram slice a single bucket may touch in the second pass, half of a typical 32KB L1D.
+constexpr size_t PARTITION_SLICE_BYTES = 16 * 1024;
+
+struct PartitionLayout {
+    size_t bucketShift; // bucket of a value is value >> bucketShift
+    size_t numBuckets;
+    size_t countStride; // per thread stride into bucketCounts, padded to a cache line
+};
+
+// picks the widest bucket that fits sliceBytes, narrowed until there is at least one bucket per thread.
+PartitionLayout planPartitionLayout(size_t maxVal, size_t threadAmount, size_t sliceBytes = PARTITION_SLICE_BYTES);
+
+// pass 1 scatters data into partitioned[dataSize] grouped by bucket, pass 2 counts every bucket's
+// slice of histogram on its own, so no reduction is needed. bucketCounts holds threadAmount * countStride.
+void solveThreadedPartitionedHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram,
+    const std::shared_ptr<int[]>& partitioned, const std::shared_ptr<size_t[]>& bucketCounts,
+    size_t dataSize, size_t maxVal, size_t threadAmount, const PartitionLayout& layout, ThreadPool& pool);
+
+void profile_threaded_partitioned_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                                size_t dataSize, int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_PARTITIONEDHISTOGRAM_HPP
@@ -0,0 +1,215 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "PerfCounters.hpp"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+    namespace {
+        std::atomic<bool>& enabledFlag() {
+            static std::atomic<bool> flag{false};
+            return flag;
+        }
+
+#ifdef __linux__
+        struct EventConfig {
+            uint32_t type;
+            uint64_t config;
+        };
+
+        constexpr uint64_t cacheMissConfig(const uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        // indexed by Event.
+        constexpr std::array<EventConfig, EVENT_COUNT> EVENT_CONFIGS = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, cacheMissConfig(PERF_COUNT_HW_CACHE_DTLB)},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+        }};
+
+        int openEvent(const EventConfig& config, const pid_t tid, const int groupFd) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = config.type;
+            attr.config = config.config;
+            attr.disabled = groupFd == -1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            // software events like context switches only fire in the kernel, try with it first. Hardware
+            // events are user space only, which is all perf_event_paranoid 2 allows anyway.
+            if (config.type == PERF_TYPE_SOFTWARE) {
+                const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, groupFd, 0));
+                if (fd >= 0) return fd;
+            }
+            attr.exclude_kernel = 1;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, groupFd, 0));
+        }
+
+        struct Group {
+            int leader = -1;
+            std::vector<int> fds;          // leader first, in read order
+            std::vector<Event> events;     // parallel to fds
+        };
+
+        constexpr size_t FIRST_SOFTWARE_EVENT = static_cast<size_t>(Event::TaskClock);
+
+        // hardware and software events go in separate groups, a hardware group too big for the PMU is never
+        // scheduled and would otherwise take the software counts down with it.
+        Group openGroup(const pid_t tid, const size_t firstEvent, const size_t lastEvent) {
+            Group group;
+            for (size_t e = firstEvent; e < lastEvent; ++e) {
+                const int fd = openEvent(EVENT_CONFIGS[e], tid, group.leader);
+                if (fd < 0) continue;  // unsupported here, the column stays empty
+                if (group.leader == -1) group.leader = fd;
+                group.fds.push_back(fd);
+                group.events.push_back(static_cast<Event>(e));
+            }
+            return group;
+        }
+
+        void closeGroup(const Group& group) {
+            for (const int fd : group.fds) {
+                close(fd);
+            }
+        }
+
+        std::vector<pid_t> processThreads() {
+            std::vector<pid_t> tids;
+            if (DIR* dir = opendir("/proc/self/task")) {
+                while (const dirent* entry = readdir(dir)) {
+                    if (entry->d_name[0] != '.') {
+                        tids.push_back(static_cast<pid_t>(std::atoi(entry->d_name)));
+                    }
+                }
+                closedir(dir);
+            }
+            return tids;
+        }
+
+        std::vector<Group>& activeGroups() {
+            static std::vector<Group> groups;
+            return groups;
+        }
+#endif
+    }
+
+    const char* eventName(const Event event) {
+        switch (event) {
+            case Event::Cycles:          return "cycles";
+            case Event::Instructions:    return "instructions";
+            case Event::L1dMisses:       return "l1d_misses";
+            case Event::LlcMisses:       return "llc_misses";
+            case Event::BranchMisses:    return "branch_misses";
+            case Event::DtlbMisses:      return "dtlb_misses";
+            case Event::TaskClock:       return "task_clock_ns";
+            case Event::PageFaults:      return "page_faults";
+            default:                     return "context_switches";
+        }
+    }
+
+    const char* eventHeader(const Event event) {
+        switch (event) {
+            case Event::Cycles:          return "Cyc/e";
+            case Event::Instructions:    return "Ins/e";
+            case Event::L1dMisses:       return "L1D/e";
+            case Event::LlcMisses:       return "LLC/e";
+            case Event::BranchMisses:    return "BrMiss/e";
+            case Event::DtlbMisses:      return "dTLB/e";
+            case Event::TaskClock:       return "TaskNs/e";
+            case Event::PageFaults:      return "Flt/e";
+            default:                     return "CSw/e";
+        }
+    }
+
+    void setEnabled(const bool on) {
+        enabledFlag().store(on, std::memory_order_relaxed);
+    }
+
+    bool enabled() {
+        return enabledFlag().load(std::memory_order_relaxed);
+    }
+
+    std::string describe() {
+#ifdef __linux__
+        static const std::string description = []() -> std::string {
+            const Group hardware = openGroup(0, 0, FIRST_SOFTWARE_EVENT);
+            const Group software = openGroup(0, FIRST_SOFTWARE_EVENT, EVENT_COUNT);
+            const std::string result = !hardware.fds.empty() ? "hardware" : !software.fds.empty() ? "software" : "unavailable";
+            closeGroup(hardware);
+            closeGroup(software);
+            return result;
+        }();
+        return description;
+#else
+        return "unavailable";
+#endif
+    }
+
+    void begin() {
+#ifdef __linux__
+        auto& groups = activeGroups();
+        for (const pid_t tid : processThreads()) {
+            for (const auto& [first, last] : {std::pair{size_t{0}, FIRST_SOFTWARE_EVENT}, std::pair{FIRST_SOFTWARE_EVENT, EVENT_COUNT}}) {
+                Group group = openGroup(tid, first, last);
+                if (group.leader == -1) continue;
+                ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                groups.push_back(std::move(group));
+            }
+        }
+        // enabled last, so opening the other groups is not counted.
+        for (const Group& group : groups) {
+            ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    Counts end() {
+        Counts counts;
+#ifdef __linux__
+        auto& groups = activeGroups();
+        for (const Group& group : groups) {
+            ioctl(group.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+        for (const Group& group : groups) {
+            // nr, time_enabled, time_running, then one value per event.
+            std::vector<uint64_t> buffer(3 + group.fds.size());
+            const ssize_t bytes = read(group.leader, buffer.data(), buffer.size() * sizeof(uint64_t));
+            if (bytes == static_cast<ssize_t>(buffer.size() * sizeof(uint64_t)) && buffer[2] > 0) {
+                // scale up if the group was multiplexed off the PMU for part of the run.
+                const double scale = static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]);
+                for (size_t i = 0; i < group.events.size(); ++i) {
+                    const auto e = static_cast<size_t>(group.events[i]);
+                    counts.values[e] += static_cast<double>(buffer[3 + i]) * scale;
+                    counts.valid[e] = true;
+                }
+            }
+            closeGroup(group);
+        }
+        groups.clear();
+#endif
+        return counts;
+    }
+}
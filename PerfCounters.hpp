@@ -0,0 +1,69 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_PERFCOUNTERS_HPP
+#define CUDAHISTOGRAMS_PERFCOUNTERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+// Optional counter groups around timed iterations. On Linux every thread of the process gets one
+// perf_event_open group, so pool workers are counted along with the caller. When the PMU is not exposed
+// (containers, most VMs, perf_event_paranoid) the hardware events fail to open and the group falls back
+// to the software events, elsewhere nothing is counted.
+namespace perf {
+
+    enum class Event : size_t {
+        Cycles,
+        Instructions,
+        L1dMisses,
+        LlcMisses,
+        BranchMisses,
+        DtlbMisses,
+        TaskClock,      // ns
+        PageFaults,
+        ContextSwitches
+    };
+
+    constexpr size_t EVENT_COUNT = static_cast<size_t>(Event::ContextSwitches) + 1;
+
+    // snake case, used for the csv/json columns.
+    const char* eventName(Event event);
+    // short table header.
+    const char* eventHeader(Event event);
+
+    struct Counts {
+        std::array<double, EVENT_COUNT> values{};
+        std::array<bool, EVENT_COUNT> valid{};
+
+        Counts& operator+=(const Counts& other) {
+            for (size_t e = 0; e < EVENT_COUNT; ++e) {
+                values[e] += other.values[e];
+                valid[e] = valid[e] || other.valid[e];
+            }
+            return *this;
+        }
+
+        bool any() const {
+            for (const bool v : valid) {
+                if (v) return true;
+            }
+            return false;
+        }
+    };
+
+    void setEnabled(bool on);
+    bool enabled();
+
+    // "hardware", "software" or "unavailable", probes once.
+    std::string describe();
+
+    // opens and starts a group on every current thread, end() stops, reads and closes them.
+    // Not reentrant, the profile functions time one thing at a time.
+    void begin();
+    Counts end();
+}
+
+#endif //CUDAHISTOGRAMS_PERFCOUNTERS_HPP
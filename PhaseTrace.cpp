@@ -0,0 +1,182 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "PhaseTrace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+    namespace {
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Ring>> rings;
+            std::vector<Ring*> freeRings;
+            std::vector<std::string> runLabels{"untimed"}; // run 0
+        };
+
+        Registry& registry() {
+            static Registry r;
+            return r;
+        }
+
+        // events in write order for one ring, at most the last TRACE_RING_EVENTS.
+        std::vector<Event> snapshot(const Ring& ring) {
+            const uint64_t written = ring.written.load(std::memory_order_acquire);
+            const uint64_t first = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+            std::vector<Event> events;
+            events.reserve(static_cast<size_t>(written - first));
+            for (uint64_t i = first; i < written; ++i) {
+                events.push_back(ring.events[i % TRACE_RING_EVENTS]);
+            }
+            return events;
+        }
+
+        std::string jsonEscape(const std::string& s) {
+            std::string escaped;
+            for (const char c : s) {
+                if (c == '"' || c == '\\') escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        }
+    }
+
+    const char* phaseName(const Phase phase) {
+        switch (phase) {
+            case Phase::Queue:   return "queue";
+            case Phase::Count:   return "count";
+            case Phase::Scatter: return "scatter";
+            case Phase::Barrier: return "barrier";
+            default:             return "reduce";
+        }
+    }
+
+    detail::Lease::Lease() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.freeRings.empty()) {
+            ring = r.freeRings.back();
+            r.freeRings.pop_back();
+            return;
+        }
+        r.rings.push_back(std::make_unique<Ring>());
+        ring = r.rings.back().get();
+        ring->lane = static_cast<uint32_t>(r.rings.size() - 1);
+    }
+
+    detail::Lease::~Lease() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.freeRings.push_back(ring);
+    }
+
+    void setEnabled(const bool on) {
+        detail::enabledFlag().store(on, std::memory_order_relaxed);
+    }
+
+    void beginRun(const std::string& label) {
+        if (!enabled()) return;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.runLabels.push_back(label);
+        detail::currentRun().store(static_cast<uint32_t>(r.runLabels.size() - 1), std::memory_order_relaxed);
+    }
+
+    void endRun() {
+        detail::currentRun().store(0, std::memory_order_relaxed);
+    }
+
+    void clear() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& ring : r.rings) {
+            ring->written.store(0, std::memory_order_relaxed);
+        }
+        r.runLabels.resize(1);
+        detail::currentRun().store(0, std::memory_order_relaxed);
+    }
+
+    void writeChromeTrace(std::ostream& os) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        uint64_t origin = UINT64_MAX;
+        std::vector<std::vector<Event>> lanes;
+        for (const auto& ring : r.rings) {
+            lanes.push_back(snapshot(*ring));
+            for (const Event& e : lanes.back()) {
+                origin = std::min(origin, e.beginNs);
+            }
+        }
+
+        os << std::fixed << std::setprecision(3);
+        os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        bool first = true;
+        for (size_t lane = 0; lane < lanes.size(); ++lane) {
+            os << (first ? "" : ",") << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << lane
+               << ", \"args\": {\"name\": \"worker lane " << lane << "\"}}";
+            first = false;
+            for (const Event& e : lanes[lane]) {
+                const std::string& label = e.run < r.runLabels.size() ? r.runLabels[e.run] : r.runLabels[0];
+                os << ",\n{\"name\": \"" << phaseName(e.phase) << "\", \"cat\": \"" << jsonEscape(label)
+                   << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << lane
+                   << ", \"ts\": " << static_cast<double>(e.beginNs - origin) / 1000.0
+                   << ", \"dur\": " << static_cast<double>(e.endNs - e.beginNs) / 1000.0
+                   << ", \"args\": {\"run\": " << e.run << "}}";
+            }
+        }
+        os << "\n]}\n";
+    }
+
+    bool writeChromeTrace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) return false;
+        writeChromeTrace(out);
+        return static_cast<bool>(out);
+    }
+
+    void printImbalance(std::ostream& os) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        // label -> phase -> lane -> summed ns, timed runs only.
+        std::map<std::string, std::map<Phase, std::map<uint32_t, uint64_t>>> busy;
+        for (const auto& ring : r.rings) {
+            for (const Event& e : snapshot(*ring)) {
+                if (e.run == 0 || e.run >= r.runLabels.size()) continue;
+                busy[r.runLabels[e.run]][e.phase][ring->lane] += e.endNs - e.beginNs;
+            }
+        }
+
+        if (busy.empty()) {
+            os << "No trace events collected.\n";
+            return;
+        }
+
+        os << "Per phase time summed over timed iterations, max and mean across worker lanes:\n";
+        for (const auto& [label, phases] : busy) {
+            os << label << "\n";
+            for (const auto& [phase, lanes] : phases) {
+                uint64_t total = 0, slowest = 0;
+                for (const auto& [lane, ns] : lanes) {
+                    total += ns;
+                    slowest = std::max(slowest, ns);
+                }
+                const double mean = static_cast<double>(total) / static_cast<double>(lanes.size());
+                os << "  " << std::left << std::setw(8) << phaseName(phase) << std::right
+                   << " lanes " << std::setw(3) << lanes.size()
+                   << "  max " << std::fixed << std::setprecision(3) << std::setw(10) << static_cast<double>(slowest) / 1e6 << " ms"
+                   << "  mean " << std::setw(10) << mean / 1e6 << " ms"
+                   << "  imbalance " << std::setw(6) << std::setprecision(1)
+                   << (mean > 0.0 ? (static_cast<double>(slowest) / mean - 1.0) * 100.0 : 0.0) << "%\n";
+                os.unsetf(std::ios::fixed);
+            }
+        }
+    }
+}
@@ -0,0 +1,117 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_PHASETRACE_HPP
+#define CUDAHISTOGRAMS_PHASETRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Per worker phase timestamps for the threaded solvers. Every thread writes into its own preallocated ring,
+// so the hot path is a clock read and two stores, no locks and no lookups. When tracing is off a Scope is a
+// single relaxed load. Rings outlive their threads and are handed to the next thread that starts tracing, a
+// ring keeps the latest TRACE_RING_EVENTS events.
+namespace trace {
+
+    constexpr size_t TRACE_RING_EVENTS = 1 << 15;
+
+    enum class Phase : uint8_t {
+        Queue,   // task sat in the pool queue
+        Count,   // counting into private histograms
+        Scatter, // partitioning the input
+        Barrier, // waiting for the other workers
+        Reduce   // merging private histograms
+    };
+
+    const char* phaseName(Phase phase);
+
+    struct Event {
+        uint64_t beginNs;
+        uint64_t endNs;
+        uint32_t run;   // 0 outside a timed iteration, e.g. warmups
+        Phase phase;
+    };
+
+    struct Ring {
+        uint32_t lane = 0;
+        std::unique_ptr<Event[]> events{new Event[TRACE_RING_EVENTS]};
+        std::atomic<uint64_t> written{0};
+    };
+
+    namespace detail {
+        inline std::atomic<bool>& enabledFlag() {
+            static std::atomic<bool> flag{false};
+            return flag;
+        }
+
+        inline std::atomic<uint32_t>& currentRun() {
+            static std::atomic<uint32_t> run{0};
+            return run;
+        }
+
+        // takes a free ring or makes a new lane on a thread's first event and gives it back when the thread
+        // exits, the only places that lock.
+        struct Lease {
+            Ring* ring;
+            Lease();
+            ~Lease();
+        };
+
+        inline Ring& localRing() {
+            thread_local Lease lease;
+            return *lease.ring;
+        }
+    }
+
+    inline bool enabled() {
+        return detail::enabledFlag().load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool on);
+
+    inline uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // single writer: only the owning thread pushes, readers only look after the traced work has joined.
+    inline void record(const Phase phase, const uint64_t beginNs, const uint64_t endNs) {
+        Ring& ring = detail::localRing();
+        const uint64_t n = ring.written.load(std::memory_order_relaxed);
+        ring.events[n % TRACE_RING_EVENTS] = {beginNs, endNs, detail::currentRun().load(std::memory_order_relaxed), phase};
+        ring.written.store(n + 1, std::memory_order_release);
+    }
+
+    class Scope {
+        const Phase phase;
+        const uint64_t begin;
+    public:
+        explicit Scope(const Phase phase) : phase(phase), begin(enabled() ? now() : 0) {}
+        ~Scope() {
+            if (begin) record(phase, begin, now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // labels every event until endRun(), called by TIMING_BEGIN/TIMING_END.
+    void beginRun(const std::string& label);
+    void endRun();
+
+    // drops every event and run label.
+    void clear();
+
+    // trace event format, open in chrome://tracing or ui.perfetto.dev. One lane per ring.
+    void writeChromeTrace(std::ostream& os);
+    bool writeChromeTrace(const std::string& path);
+
+    // per run label and phase: summed time of the busiest lane against the mean lane, plus barrier wait.
+    void printImbalance(std::ostream& os = std::cout);
+}
+
+#endif //CUDAHISTOGRAMS_PHASETRACE_HPP
@@ -0,0 +1,145 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "RunAwareHistogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <immintrin.h>
+
+#include "PackedInput.hpp"
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+namespace {
+    void countPlain(const int* data, const size_t count, int* hist) {
+        for (size_t i = 0; i < count; ++i) {
+            ++hist[data[i]];
+        }
+    }
+
+    // finishes [i, count) of the run in progress one element at a time, then flushes it.
+    void finishRuns(const int* data, size_t i, const size_t count, int value, int run, int* hist) {
+        for (; i < count; ++i) {
+            if (data[i] == value) {
+                ++run;
+            } else {
+                hist[value] += run;
+                value = data[i];
+                run = 1;
+            }
+        }
+        hist[value] += run;
+    }
+
+    void countRunsScalar(const int* data, const size_t count, int* hist) {
+        finishRuns(data, 1, count, data[0], 1, hist);
+    }
+
+    // all lanes equal extends the run by 8, otherwise the leading equal lanes close it and the first
+    // different element starts the next one.
+    HISTOGRAM_TARGET_AVX2
+    void countRunsAvx2(const int* data, const size_t count, int* hist) {
+        int value = data[0];
+        int run = 0;
+        __m256i current = _mm256_set1_epi32(value);
+        size_t i = 0;
+        while (i + 8 <= count) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            const auto equal = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, current))));
+            if (equal == 0xff) {
+                run += 8;
+                i += 8;
+                continue;
+            }
+            const int k = std::countr_one(equal);
+            hist[value] += run + k;
+            i += k;
+            value = data[i];
+            run = 0;
+            current = _mm256_set1_epi32(value);
+        }
+        finishRuns(data, i, count, value, run, hist);
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    void countRunsAvx512(const int* data, const size_t count, int* hist) {
+        int value = data[0];
+        int run = 0;
+        __m512i current = _mm512_set1_epi32(value);
+        size_t i = 0;
+        while (i + 16 <= count) {
+            const unsigned equal = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(data + i), current);
+            if (equal == 0xffff) {
+                run += 16;
+                i += 16;
+                continue;
+            }
+            const int k = std::countr_one(equal);
+            hist[value] += run + k;
+            i += k;
+            value = data[i];
+            run = 0;
+            current = _mm512_set1_epi32(value);
+        }
+        finishRuns(data, i, count, value, run, hist);
+    }
+
+    void countRunKernel(const SimdLevel level, const int* data, const size_t count, int* hist) {
+        switch (level) {
+            case SimdLevel::AVX512: countRunsAvx512(data, count, hist); break;
+            case SimdLevel::AVX2:   countRunsAvx2(data, count, hist);   break;
+            default:                countRunsScalar(data, count, hist); break;
+        }
+    }
+}
+
+size_t countRunAware(const SimdLevel level, const int* data, const size_t count, int* hist) {
+    size_t runBlocks = 0;
+    for (size_t base = 0; base < count; base += RUN_AWARE_BLOCK) {
+        const size_t n = std::min(RUN_AWARE_BLOCK, count - base);
+        const size_t sample = std::min(RUN_AWARE_SAMPLE, n);
+        if (sample >= RUN_AWARE_MIN_RUN * countRuns(data + base, sample)) {
+            countRunKernel(level, data + base, n, hist);
+            ++runBlocks;
+        } else {
+            countPlain(data + base, n, hist);
+        }
+    }
+    return runBlocks;
+}
+
+void solveThreadedRunAwareHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const size_t perThreadInts, const SimdLevel level, ThreadPool& pool) {
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &data, &privateHistograms](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        countRunAware(level, data.get() + start, end - start, privateHistograms.get() + t * perThreadInts);
+    }).wait();
+
+    reduceBinSliced<true>(privateHistograms.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+}
+
+void profile_threaded_run_aware_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                              const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool,
+                                              const SimdLevel level) {
+    const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int);
+    const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+
+    // warmup
+    solveThreadedRunAwareHistogram(data, testHistogram, privateHistograms, dataSize, maxVal, threadAmount, perThreadInts, level, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveThreadedRunAwareHistogram(data, testHistogram, privateHistograms, dataSize, maxVal, threadAmount, perThreadInts, level, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
@@ -0,0 +1,34 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_RUNAWAREHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_RUNAWAREHISTOGRAM_HPP
+
+#include <memory>
+#include <string>
+
+#include "Common.hpp"
+#include "CpuFeatures.hpp"
+#include "ThreadPool.hpp"
+
+// elements per adaptive decision, and how many at the head of each block are sampled for it.
+constexpr size_t RUN_AWARE_BLOCK = 4096;
+constexpr size_t RUN_AWARE_SAMPLE = 64;
+// sampled mean run length from which the run kernel beats one increment per element.
+constexpr size_t RUN_AWARE_MIN_RUN = 8;
+
+// Long runs of one value make the plain loop wait on store-to-load forwarding of that one counter. Every
+// block samples its head; run heavy blocks compare a vector of inputs against the current value and credit
+// hist[v] += run once per run, the rest take the plain loop. Returns how many blocks took the run kernel.
+size_t countRunAware(SimdLevel level, const int* data, size_t count, int* hist);
+
+// privateHistograms holds threadAmount * perThreadInts ints, zero on entry and zeroed again by the reduction.
+void solveThreadedRunAwareHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& privateHistograms,
+    size_t dataSize, size_t maxVal, size_t threadAmount, size_t perThreadInts, SimdLevel level, ThreadPool& pool);
+
+void profile_threaded_run_aware_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                              size_t dataSize, int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool,
+                                              SimdLevel level = detectSimdLevel());
+
+#endif //CUDAHISTOGRAMS_RUNAWAREHISTOGRAM_HPP
@@ -0,0 +1,227 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "ShardedHistogram.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "BinnedHistogram.hpp"
+#include "Common.hpp"
+#include "ThreadPlacement.hpp"
+#include "Timer.hpp"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+#if !defined(_WIN32)
+namespace {
+    struct Worker {
+        pid_t pid = -1;
+        int fd = -1;
+    };
+
+    bool writeAll(const int fd, const uint8_t* bytes, size_t size) {
+        while (size > 0) {
+            const ssize_t written = write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool readAll(const int fd, std::vector<uint8_t>& out) {
+        uint8_t buffer[64 << 10];
+        for (;;) {
+            const ssize_t got = read(fd, buffer, sizeof(buffer));
+            if (got == 0) return true;
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            out.insert(out.end(), buffer, buffer + got);
+        }
+    }
+
+    Worker spawnWorker(const std::string& path, const ElementWidth width, const size_t maxVal, const MappedRange range, const size_t threads, const size_t node) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+            throw std::runtime_error("Could not create a shard socket");
+        }
+        // only the worker's end survives the exec.
+        fcntl(fds[1], F_SETFD, 0);
+
+        std::vector<std::string> args = {"/proc/self/exe", SHARD_WORKER_FLAG, path, std::to_string(static_cast<size_t>(width)), std::to_string(maxVal),
+                                         std::to_string(range.begin), std::to_string(range.end), std::to_string(threads), std::to_string(node),
+                                         std::to_string(fds[1])};
+        std::vector<char*> argv;
+        for (std::string& arg : args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        Worker worker;
+        const int spawned = posix_spawn(&worker.pid, argv[0], nullptr, nullptr, argv.data(), environ);
+        close(fds[1]);
+        if (spawned != 0) {
+            close(fds[0]);
+            throw std::runtime_error("Could not start a shard worker");
+        }
+        worker.fd = fds[0];
+        return worker;
+    }
+
+    template<typename T>
+    PartialHistogram countShard(const std::shared_ptr<MappedInputFile>& file, const size_t maxVal, const size_t begin, const size_t end, const size_t threads) {
+        // aliases the mapping at the shard's first element, like mappedIntArray.
+        const std::shared_ptr<T[]> data(file, const_cast<T*>(file->data<T>() + begin));
+        const IdentityMapper<T> mapper(maxVal);
+        const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int);
+        const std::shared_ptr<int[]> privateHistograms = makeAlignedArray<int>(perThreadInts * threads, systemPageSize());
+        clear(privateHistograms.get(), perThreadInts * threads);
+        const std::shared_ptr<int[]> histogram(new int[maxVal]);
+        clear(histogram.get(), maxVal);
+
+        ThreadPool pool(threads);
+        solveThreadedBinnedHistogram(data, histogram, privateHistograms, end - begin, mapper, threads, perThreadInts, pool);
+        return PartialHistogram::dense(histogram.get(), maxVal, end - begin, identityBins(maxVal)).compact();
+    }
+}
+#endif
+
+PartialHistogram runShardedHistogram(const std::string& path, const ElementWidth width, const size_t maxVal, const size_t shards, const size_t threadsPerShard,
+                                     ThreadPool& pool) {
+#if defined(_WIN32)
+    throw std::runtime_error("sharded histograms need posix_spawn");
+#else
+    std::vector<MappedRange> ranges;
+    {
+        const MappedInputFile file(path, width);
+        ranges = file.ranges(shards);
+    }
+
+    // shard s runs on node s % nodes, so every node gets its share of the workers.
+    const std::vector<size_t> nodes = cpuNodes();
+    std::vector<Worker> workers;
+    try {
+        for (size_t s = 0; s < ranges.size(); ++s) {
+            workers.push_back(spawnWorker(path, width, maxVal, ranges[s], threadsPerShard, nodes.empty() ? 0 : nodes[s % nodes.size()]));
+        }
+    } catch (...) {
+        for (const Worker& worker : workers) {
+            close(worker.fd);
+            waitpid(worker.pid, nullptr, 0);
+        }
+        throw;
+    }
+
+    // a worker blocks once its socket buffer is full, so every socket gets drained concurrently.
+    std::vector<std::vector<uint8_t>> received(workers.size());
+    std::vector<char> readOk(workers.size(), 0);
+    pool.parallel_for(0, workers.size(), 1, [&](const size_t s) {
+        readOk[s] = readAll(workers[s].fd, received[s]);
+        close(workers[s].fd);
+    }).wait();
+
+    bool workersOk = true;
+    for (size_t s = 0; s < workers.size(); ++s) {
+        int status = 0;
+        while (waitpid(workers[s].pid, &status, 0) < 0 && errno == EINTR) {}
+        workersOk &= readOk[s] && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    if (!workersOk) {
+        throw std::runtime_error("a shard worker failed");
+    }
+
+    std::vector<PartialHistogram> partials;
+    partials.reserve(received.size());
+    for (const std::vector<uint8_t>& bytes : received) {
+        partials.push_back(PartialHistogram::deserialize(bytes.data(), bytes.size()));
+    }
+    return mergePartialHistograms(partials, pool);
+#endif
+}
+
+int runShardWorker(const int argc, char** argv) {
+#if defined(_WIN32)
+    std::cerr << "sharded histograms need posix_spawn" << std::endl;
+    return 1;
+#else
+    if (argc != 10) {
+        std::cerr << "Usage: " << argv[0] << " " << SHARD_WORKER_FLAG << " <path> <width> <maxVal> <begin> <end> <threads> <node> <fd>" << std::endl;
+        return 1;
+    }
+    try {
+        const std::string path = argv[2];
+        const auto width = static_cast<ElementWidth>(std::stoul(argv[3]));
+        const size_t maxVal = std::stoul(argv[4]);
+        const size_t begin = std::stoull(argv[5]);
+        const size_t end = std::stoull(argv[6]);
+        const size_t threads = std::max<size_t>(std::stoul(argv[7]), 1);
+        const size_t node = std::stoul(argv[8]);
+        const int fd = std::stoi(argv[9]);
+
+        // before countShard zeroes its histograms and starts the pool, so pages and threads all stay on the node.
+        pinToNode(node);
+
+        const auto file = std::make_shared<MappedInputFile>(path, width);
+        if (begin > end || end > file->size()) {
+            throw std::out_of_range("shard range outside " + path);
+        }
+
+        PartialHistogram partial;
+        switch (width) {
+            case ElementWidth::U8:  partial = countShard<uint8_t>(file, maxVal, begin, end, threads);  break;
+            case ElementWidth::U16: partial = countShard<uint16_t>(file, maxVal, begin, end, threads); break;
+            case ElementWidth::I32: partial = countShard<int32_t>(file, maxVal, begin, end, threads);  break;
+            default: throw std::invalid_argument("element width must be 1, 2 or 4 bytes");
+        }
+
+        const std::vector<uint8_t> bytes = partial.serialize();
+        const bool sent = writeAll(fd, bytes.data(), bytes.size());
+        close(fd);
+        return sent ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "shard worker: " << e.what() << std::endl;
+        return 1;
+    }
+#endif
+}
+
+void profile_sharded_file_cpu_histogram(const std::string& path, const ElementWidth width, const std::shared_ptr<int[]> &truthHistogram,
+                                        const std::shared_ptr<int[]> &testHistogram, const size_t dataSize, const int maxVal, const size_t shards,
+                                        const size_t threadsPerShard, const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const size_t threadAmount = shards * threadsPerShard;
+    const auto run = [&]() {
+        const PartialHistogram merged = runShardedHistogram(path, width, maxVal, shards, threadsPerShard, pool);
+        for (int b = 0; b < maxVal; ++b) {
+            testHistogram[b] = static_cast<int>(merged.count(b));
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        run();
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
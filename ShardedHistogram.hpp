@@ -0,0 +1,35 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_SHARDEDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_SHARDEDHISTOGRAM_HPP
+
+#include <memory>
+#include <string>
+
+#include "MappedInput.hpp"
+#include "PartialHistogram.hpp"
+#include "ThreadPool.hpp"
+
+// first argument of a spawned worker, main() hands those straight to runShardWorker.
+constexpr const char* SHARD_WORKER_FLAG = "--shard-worker";
+
+// Splits the file into shards page aligned ranges and counts each one in its own process: every worker is
+// this executable started with SHARD_WORKER_FLAG, maps the file itself, runs the binned solver on its range
+// with threadsPerShard threads and sends back a compact PartialHistogram over a Unix socket. The coordinator
+// reads all sockets on the pool and merges the partials bin sliced. The partials carry everything needed to
+// merge them, so shards on other hosts only need a different transport. Shard s is pinned to NUMA node
+// s % nodes, its threads and private histograms stay on that node.
+// Throws std::runtime_error if a worker fails or sends a bad partial (and on Windows, which has no workers).
+PartialHistogram runShardedHistogram(const std::string& path, ElementWidth width, size_t maxVal, size_t shards, size_t threadsPerShard, ThreadPool& pool);
+
+// worker side: argv is `<exe> --shard-worker <path> <width> <maxVal> <begin> <end> <threads> <node> <fd>`.
+int runShardWorker(int argc, char** argv);
+
+// timed end to end, process start up and merge included. Timings are keyed by shards * threadsPerShard threads.
+void profile_sharded_file_cpu_histogram(const std::string& path, ElementWidth width, const std::shared_ptr<int[]> &truthHistogram,
+                                        const std::shared_ptr<int[]> &testHistogram, size_t dataSize, int maxVal, size_t shards,
+                                        size_t threadsPerShard, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_SHARDEDHISTOGRAM_HPP
@@ -0,0 +1,169 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "SimdHistogram.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <immintrin.h>
+#include <vector>
+
+#include "PhaseTrace.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+namespace {
+    void countScalar(const int* data, const size_t count, int* hist) {
+        constexpr size_t copies = SIMD_SCALAR_COPIES;
+        size_t i = 0;
+        for (; i + copies <= count; i += copies) {
+            ++hist[static_cast<size_t>(data[i])     * copies];
+            ++hist[static_cast<size_t>(data[i + 1]) * copies + 1];
+            ++hist[static_cast<size_t>(data[i + 2]) * copies + 2];
+            ++hist[static_cast<size_t>(data[i + 3]) * copies + 3];
+        }
+        for (; i < count; ++i) {
+            ++hist[static_cast<size_t>(data[i]) * copies];
+        }
+    }
+
+    HISTOGRAM_TARGET_AVX2
+    void countAvx2(const int* data, const size_t count, int* hist) {
+        constexpr size_t copies = SIMD_AVX2_COPIES;
+        // AVX2 has no scatter, so the offsets are computed in vector registers and the increments
+        // are issued as scalar stores into 4 distinct copies.
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 0, 1, 2, 3);
+        alignas(32) int offsets[8];
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            _mm256_store_si256(reinterpret_cast<__m256i*>(offsets), _mm256_add_epi32(_mm256_slli_epi32(idx, 2), lanes));
+            ++hist[offsets[0]];
+            ++hist[offsets[1]];
+            ++hist[offsets[2]];
+            ++hist[offsets[3]];
+            ++hist[offsets[4]];
+            ++hist[offsets[5]];
+            ++hist[offsets[6]];
+            ++hist[offsets[7]];
+        }
+        for (; i < count; ++i) {
+            ++hist[static_cast<size_t>(data[i]) * copies];
+        }
+    }
+
+    // per lane popcount of the VPCONFLICTD result, which has at most 15 bits set.
+    HISTOGRAM_TARGET_AVX512
+    __m512i popcount16(__m512i v) {
+        v = _mm512_sub_epi32(v, _mm512_and_si512(_mm512_srli_epi32(v, 1), _mm512_set1_epi32(0x5555)));
+        v = _mm512_add_epi32(_mm512_and_si512(v, _mm512_set1_epi32(0x3333)),
+                             _mm512_and_si512(_mm512_srli_epi32(v, 2), _mm512_set1_epi32(0x3333)));
+        v = _mm512_and_si512(_mm512_add_epi32(v, _mm512_srli_epi32(v, 4)), _mm512_set1_epi32(0x0F0F));
+        return _mm512_and_si512(_mm512_add_epi32(v, _mm512_srli_epi32(v, 8)), _mm512_set1_epi32(0x1F));
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    void scatterIncrement(int* hist, const __m512i idx) {
+        // each lane adds 1 + (number of earlier lanes with the same bin). Scatter writes overlapping
+        // lanes in order, so the last duplicate stores the full count for that bin.
+        const __m512i increment = _mm512_add_epi32(popcount16(_mm512_conflict_epi32(idx)), _mm512_set1_epi32(1));
+        const __m512i counts = _mm512_i32gather_epi32(idx, hist, sizeof(int));
+        _mm512_i32scatter_epi32(hist, idx, _mm512_add_epi32(counts, increment), sizeof(int));
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    void countAvx512(const int* data, const size_t count, int* hist) {
+        static_assert(SIMD_AVX512_COPIES == 2);
+        // alternate copies between consecutive vectors so a gather never waits on the previous scatter.
+        const __m512i copy1 = _mm512_set1_epi32(1);
+
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            const __m512i idx0 = _mm512_slli_epi32(_mm512_loadu_si512(data + i), 1);
+            const __m512i idx1 = _mm512_add_epi32(_mm512_slli_epi32(_mm512_loadu_si512(data + i + 16), 1), copy1);
+            scatterIncrement(hist, idx0);
+            scatterIncrement(hist, idx1);
+        }
+        for (; i < count; ++i) {
+            ++hist[static_cast<size_t>(data[i]) * SIMD_AVX512_COPIES];
+        }
+    }
+}
+
+size_t simdHistogramCopies(const SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512: return SIMD_AVX512_COPIES;
+        case SimdLevel::AVX2:   return SIMD_AVX2_COPIES;
+        default:                return SIMD_SCALAR_COPIES;
+    }
+}
+
+void countSimdHistogram(const SimdLevel level, const int* data, const size_t count, int* hist) {
+    switch (level) {
+        case SimdLevel::AVX512: countAvx512(data, count, hist); break;
+        case SimdLevel::AVX2:   countAvx2(data, count, hist);   break;
+        default:                countScalar(data, count, hist); break;
+    }
+}
+
+void foldSimdHistogram(int* hist, const size_t maxVal, const size_t copies) {
+    // bin b is written to hist[b] after its copies at hist[b * copies ...] were read, and b <= b * copies,
+    // so folding front to back never clobbers a copy that is still needed.
+    for (size_t b = 0; b < maxVal; ++b) {
+        int sum = 0;
+        for (size_t c = 0; c < copies; ++c) {
+            sum += hist[b * copies + c];
+        }
+        hist[b] = sum;
+    }
+}
+
+void solveThreadedSimdHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& simdHistogram,
+    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const size_t perThreadInts, const SimdLevel level, ThreadPool& pool) {
+    const size_t copies = simdHistogramCopies(level);
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    std::vector<std::future<void>> futures;
+    for (size_t t = 0; t < threadAmount; ++t) {
+        futures.push_back(pool.queue([=, &data, &simdHistogram]() {
+            trace::Scope scope(trace::Phase::Count);
+            int* hist = simdHistogram.get() + t * perThreadInts;
+            const size_t start = std::min(t * elementsPerThread, dataSize);
+            const size_t end   = std::min(start + elementsPerThread, dataSize);
+
+            countSimdHistogram(level, data.get() + start, end - start, hist);
+            foldSimdHistogram(hist, maxVal, copies);
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    reduceBinSliced(simdHistogram.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+}
+
+void profile_threaded_simd_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                         const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool,
+                                         const SimdLevel level) {
+    const size_t pageInts = systemPageSize() / sizeof(int);
+    const size_t copies = simdHistogramCopies(level);
+    const size_t perThreadInts = (static_cast<size_t>(maxVal) * copies + pageInts - 1) / pageInts * pageInts;
+    const size_t simdSize = perThreadInts * threadAmount;
+
+    const std::shared_ptr<int[]> simdHistogram = makeAlignedArray<int>(simdSize, systemPageSize());
+    clear(simdHistogram.get(), simdSize);
+
+    // warmup
+    solveThreadedSimdHistogram(data, testHistogram, simdHistogram, dataSize, maxVal, threadAmount, perThreadInts, level, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(simdHistogram.get(), simdSize);
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveThreadedSimdHistogram(data, testHistogram, simdHistogram, dataSize, maxVal, threadAmount, perThreadInts, level, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
@@ -0,0 +1,39 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_SIMDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_SIMDHISTOGRAM_HPP
+
+#include <memory>
+#include <string>
+
+#include "Common.hpp"
+#include "CpuFeatures.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+
+// every thread keeps N interleaved copies of its sub-histogram, hist[bin * N + copy], so equal
+// bins in flight never land on the same counter. AVX-512 additionally resolves duplicates within
+// one vector with VPCONFLICTD, so it needs fewer copies than the scalar/AVX2 kernels.
+constexpr size_t SIMD_SCALAR_COPIES = 4;
+constexpr size_t SIMD_AVX2_COPIES   = 4;
+constexpr size_t SIMD_AVX512_COPIES = 2;
+
+size_t simdHistogramCopies(SimdLevel level);
+
+// counts data[0, count) into the interleaved copies of hist, which must hold maxVal * copies ints.
+void countSimdHistogram(SimdLevel level, const int* data, size_t count, int* hist);
+
+// sums the interleaved copies in place, afterwards hist[0, maxVal) holds the folded sub-histogram.
+void foldSimdHistogram(int* hist, size_t maxVal, size_t copies);
+
+// simdHistogram holds threadAmount sub-histograms of perThreadInts each, zeroed by the caller.
+void solveThreadedSimdHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& simdHistogram,
+    size_t dataSize, size_t maxVal, size_t threadAmount, size_t perThreadInts, SimdLevel level, ThreadPool& pool);
+
+void profile_threaded_simd_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                         size_t dataSize, int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool,
+                                         SimdLevel level = detectSimdLevel());
+
+#endif //CUDAHISTOGRAMS_SIMDHISTOGRAM_HPP
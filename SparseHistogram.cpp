@@ -0,0 +1,218 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "SparseHistogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <stdexcept>
+
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+
+namespace {
+    int shiftFor(const size_t capacity) {
+        return 64 - std::countr_zero(capacity);
+    }
+
+    void validateSparse(const SparseHistogram& histogram, const std::shared_ptr<int[]>& truthHistogram, const size_t dataSize, const size_t maxVal) {
+        size_t total = 0;
+        histogram.forEach([&](const uint32_t key, const int count) {
+            if (key >= maxVal || truthHistogram[key] != count) {
+                std::cout << "Error at key " << key << " -> Truth: " << (key < maxVal ? truthHistogram[key] : 0) << " vs " << count << std::endl;
+                abort();
+            }
+            total += static_cast<size_t>(count);
+        });
+        // every entry matched, so a key that is missing shows up as counts short of dataSize.
+        if (total != dataSize) {
+            std::cout << "Error: sparse histogram holds " << total << " of " << dataSize << " elements" << std::endl;
+            abort();
+        }
+    }
+}
+
+SparseTable::SparseTable(const size_t capacity)
+    : slots(std::bit_ceil(std::max(capacity, SPARSE_MIN_CAPACITY)), SparseEntry{SPARSE_EMPTY_KEY, 0}),
+      shift(shiftFor(slots.size())) {
+}
+
+void SparseTable::grow() {
+    std::vector<SparseEntry> old(slots.size() * 2, SparseEntry{SPARSE_EMPTY_KEY, 0});
+    old.swap(slots);
+    shift = shiftFor(slots.size());
+    used = 0;
+    for (const SparseEntry& entry : old) {
+        if (entry.key != SPARSE_EMPTY_KEY) {
+            add(entry.key, sparseHash(entry.key), entry.count);
+        }
+    }
+}
+
+int SparseTable::count(const uint32_t key) const {
+    if (key == SPARSE_EMPTY_KEY) return emptyKeyCount;
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(sparseHash(key) >> shift);; slot = (slot + 1) & mask) {
+        const SparseEntry& entry = slots[slot];
+        if (entry.key == key) return entry.count;
+        if (entry.key == SPARSE_EMPTY_KEY) return 0;
+    }
+}
+
+void SparseTable::reserve(const size_t keys) {
+    while (keys * 2 > slots.size()) {
+        grow();
+    }
+}
+
+void SparseTable::clear() {
+    emptyKeyCount = 0;
+    if (used == 0) return;
+    std::fill(slots.begin(), slots.end(), SparseEntry{SPARSE_EMPTY_KEY, 0});
+    used = 0;
+}
+
+SparseHistogram::SparseHistogram(const size_t threadAmount)
+    : threadAmount(threadAmount), local(threadAmount * threadAmount), merged(threadAmount) {
+    if (threadAmount == 0) throw std::invalid_argument("SparseHistogram needs at least one thread");
+}
+
+size_t SparseHistogram::size() const {
+    size_t keys = 0;
+    for (const SparseTable& table : merged) {
+        keys += table.size();
+    }
+    return keys;
+}
+
+int SparseHistogram::count(const uint32_t key) const {
+    return merged[sparsePartition(sparseHash(key), threadAmount)].count(key);
+}
+
+void SparseHistogram::toDense(int* histogram, const size_t maxVal) const {
+    clear(histogram, maxVal);
+    forEach([&](const uint32_t key, const int count) {
+        if (key >= maxVal) throw std::out_of_range("sparse key " + std::to_string(key) + " outside the dense histogram");
+        histogram[key] = count;
+    });
+}
+
+void SparseHistogram::toDense(int* histogram, const size_t maxVal, ThreadPool& pool) const {
+    const size_t binsPerThread = (maxVal + threadAmount - 1) / threadAmount;
+    pool.parallel_for(0, threadAmount, 1, [=](const size_t t) {
+        const size_t begin = std::min(t * binsPerThread, maxVal);
+        const size_t end   = std::min(begin + binsPerThread, maxVal);
+        clear(histogram + begin, end - begin);
+    }).wait();
+
+    // keys are disjoint between partitions, so every partition writes its bins without synchronization.
+    std::atomic<bool> outOfRange = false;
+    pool.parallel_for(0, threadAmount, 1, [&, histogram, maxVal](const size_t p) {
+        merged[p].forEach([&](const uint32_t key, const int count) {
+            if (key < maxVal) {
+                histogram[key] = count;
+            } else {
+                outOfRange.store(true, std::memory_order_relaxed);
+            }
+        });
+    }).wait();
+    if (outOfRange) throw std::out_of_range("sparse key outside the dense histogram");
+}
+
+void solveThreadedSparseHistogram(const std::shared_ptr<int[]>& data, SparseHistogram& histogram, const size_t dataSize, ThreadPool& pool) {
+    const size_t threadAmount = histogram.threadAmount;
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [&, elementsPerThread](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        SparseTable* tables = histogram.local.data() + t * threadAmount;
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        for (size_t i = start; i < end; ++i) {
+            const auto key = static_cast<uint32_t>(data[i]);
+            const uint64_t hash = sparseHash(key);
+            tables[sparsePartition(hash, threadAmount)].add(key, hash);
+        }
+    }).wait();
+
+    pool.parallel_for(0, threadAmount, 1, [&](const size_t p) {
+        trace::Scope scope(trace::Phase::Reduce);
+        SparseTable& target = histogram.merged[p];
+        target.clear();
+        // the largest thread's share is a lower bound on the merged size, one grow instead of several.
+        size_t largest = 0;
+        for (size_t t = 0; t < threadAmount; ++t) {
+            largest = std::max(largest, histogram.local[t * threadAmount + p].size());
+        }
+        target.reserve(largest);
+        for (size_t t = 0; t < threadAmount; ++t) {
+            SparseTable& source = histogram.local[t * threadAmount + p];
+            source.forEach([&target](const uint32_t key, const int count) {
+                target.add(key, sparseHash(key), count);
+            });
+            source.clear();
+        }
+    }).wait();
+}
+
+const char* histogramOutputName(const HistogramOutput output) {
+    return output == HistogramOutput::Dense ? "dense" : "sparse";
+}
+
+size_t estimateDistinctKeys(const int* data, const size_t dataSize, const size_t maxVal) {
+    if (dataSize == 0) return 0;
+    const size_t sampleSize = std::min(dataSize, SPARSE_SAMPLE_ELEMENTS);
+    SparseTable sample(sampleSize * 2);
+    for (size_t i = 0; i < sampleSize; ++i) {
+        sample.add(static_cast<uint32_t>(data[i * dataSize / sampleSize]));
+    }
+
+    double singletons = 0, doubletons = 0;
+    sample.forEach([&](uint32_t, const int count) {
+        singletons += count == 1;
+        doubletons += count == 2;
+    });
+    // bias corrected form, stays finite without doubletons.
+    const double estimate = static_cast<double>(sample.size()) + singletons * (singletons - 1) / (2 * (doubletons + 1));
+    return std::min({static_cast<size_t>(estimate), maxVal, dataSize});
+}
+
+HistogramOutput selectHistogramOutput(const size_t estimatedKeys, const size_t maxVal, const size_t l2Bytes) {
+    if (maxVal * sizeof(int) <= l2Bytes) return HistogramOutput::Dense;
+    return static_cast<double>(estimatedKeys) < SPARSE_MAX_OCCUPANCY * static_cast<double>(maxVal) ? HistogramOutput::Sparse : HistogramOutput::Dense;
+}
+
+void profile_threaded_sparse_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           const size_t dataSize, const size_t maxVal, const size_t threadAmount, const bool densify, const std::string &testName,
+                                           const size_t iterations, ThreadPool& pool) {
+    SparseHistogram histogram(threadAmount);
+
+    // -1 is key SPARSE_EMPTY_KEY, the free slot marker. It has to be counted like any other key.
+    {
+        const std::shared_ptr<int[]> edgeKeys(new int[5]{-1, 5, -1, 5, -1});
+        solveThreadedSparseHistogram(edgeKeys, histogram, 5, pool);
+        if (histogram.size() != 2 || histogram.count(SPARSE_EMPTY_KEY) != 3 || histogram.count(5) != 2) {
+            std::cout << "Error: " << testName << " miscounts key " << SPARSE_EMPTY_KEY << std::endl;
+            abort();
+        }
+    }
+
+    // warmup, also grows every table to its working size.
+    solveThreadedSparseHistogram(data, histogram, dataSize, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        TIMING_BEGIN(testName, maxVal, dataSize, threadAmount);
+        solveThreadedSparseHistogram(data, histogram, dataSize, pool);
+        if (densify) {
+            histogram.toDense(testHistogram.get(), maxVal, pool);
+        }
+        TIMING_END(testName, maxVal, dataSize, threadAmount);
+        if (densify) {
+            validate(truthHistogram, testHistogram, maxVal);
+        } else {
+            validateSparse(histogram, truthHistogram, dataSize, maxVal);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_SPARSEHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_SPARSEHISTOGRAM_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common.hpp"
+#include "MachineInfo.hpp"
+#include "ThreadPool.hpp"
+
+// strided sample estimateDistinctKeys looks at.
+constexpr size_t SPARSE_SAMPLE_ELEMENTS = 1 << 16;
+// sparse output once fewer than this share of the bins is expected to be hit.
+constexpr double SPARSE_MAX_OCCUPANCY = 1.0 / 16;
+constexpr size_t SPARSE_MIN_CAPACITY = 64;
+constexpr uint32_t SPARSE_EMPTY_KEY = UINT32_MAX;
+
+// key and count side by side, one probe touches one cache line most of the time.
+struct SparseEntry {
+    uint32_t key;
+    int count;
+};
+
+// murmur3 finalizer. The table takes its slot from the high bits, the merge its partition from the low 32.
+inline uint64_t sparseHash(const uint32_t key) {
+    uint64_t h = key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline size_t sparsePartition(const uint64_t hash, const size_t partitions) {
+    return static_cast<size_t>(((hash & 0xffffffffULL) * partitions) >> 32);
+}
+
+// Open addressing with linear probing over one flat power of two array, kept at most half full. Growing
+// rehashes into a new array, entries are never allocated on their own. clear() keeps the capacity.
+// SPARSE_EMPTY_KEY marks free slots, so that key is counted on the side instead.
+class SparseTable {
+    std::vector<SparseEntry> slots;
+    size_t used = 0;
+    int shift;
+    int emptyKeyCount = 0;
+
+    void grow();
+
+public:
+    explicit SparseTable(size_t capacity = SPARSE_MIN_CAPACITY);
+
+    void add(const uint32_t key, const uint64_t hash, const int count = 1) {
+        if (key == SPARSE_EMPTY_KEY) [[unlikely]] {
+            emptyKeyCount += count;
+            return;
+        }
+        const size_t mask = slots.size() - 1;
+        for (size_t slot = static_cast<size_t>(hash >> shift);; slot = (slot + 1) & mask) {
+            SparseEntry& entry = slots[slot];
+            if (entry.key == key) {
+                entry.count += count;
+                return;
+            }
+            if (entry.key == SPARSE_EMPTY_KEY) {
+                if ((used + 1) * 2 > slots.size()) [[unlikely]] {
+                    grow();
+                    add(key, hash, count);
+                    return;
+                }
+                entry = {key, count};
+                ++used;
+                return;
+            }
+        }
+    }
+
+    void add(const uint32_t key) { add(key, sparseHash(key)); }
+
+    // 0 for keys that never showed up.
+    int count(uint32_t key) const;
+
+    size_t size() const { return used + (emptyKeyCount != 0); }
+    size_t capacity() const { return slots.size(); }
+
+    // grows once up front so that keys more entries fit without rehashing.
+    void reserve(size_t keys);
+    void clear();
+
+    template<typename F>
+    void forEach(F&& fn) const {
+        for (const SparseEntry& entry : slots) {
+            if (entry.key != SPARSE_EMPTY_KEY) {
+                fn(entry.key, entry.count);
+            }
+        }
+        if (emptyKeyCount != 0) {
+            fn(SPARSE_EMPTY_KEY, emptyKeyCount);
+        }
+    }
+};
+
+// Result of the sparse solver: one table per thread, every key lives in exactly one of them (picked by
+// hash). Also owns the threadAmount x threadAmount per-thread tables the count phase writes, so their
+// capacity is reused from one solve to the next.
+class SparseHistogram {
+    size_t threadAmount;
+    std::vector<SparseTable> local;      // local[t * threadAmount + p], thread t's keys of partition p
+    std::vector<SparseTable> merged;
+
+    friend void solveThreadedSparseHistogram(const std::shared_ptr<int[]>& data, SparseHistogram& histogram, size_t dataSize, ThreadPool& pool);
+
+public:
+    explicit SparseHistogram(size_t threadAmount);
+
+    size_t threads() const { return threadAmount; }
+    // distinct keys.
+    size_t size() const;
+    int count(uint32_t key) const;
+    const std::vector<SparseTable>& partitions() const { return merged; }
+
+    template<typename F>
+    void forEach(F&& fn) const {
+        for (const SparseTable& table : merged) {
+            table.forEach(fn);
+        }
+    }
+
+    // writes the dense histogram[0, maxVal), zeroing the bins no key hit. Throws std::out_of_range if a
+    // key is >= maxVal.
+    void toDense(int* histogram, size_t maxVal) const;
+    void toDense(int* histogram, size_t maxVal, ThreadPool& pool) const;
+};
+
+// Count phase: thread t inserts its share of data into local[t][partition(key)]. Merge phase: thread p
+// folds local[0..threads)[p] into merged[p] and clears them, so partitions merge without any locking.
+// histogram.threads() workers are used, pool needs at least that many to run them in parallel.
+void solveThreadedSparseHistogram(const std::shared_ptr<int[]>& data, SparseHistogram& histogram, size_t dataSize, ThreadPool& pool);
+
+enum class HistogramOutput {
+    Dense,
+    Sparse
+};
+
+const char* histogramOutputName(HistogramOutput output);
+
+// distinct keys from a strided sample with the Chao1 estimator, d + f1^2 / 2f2 (singletons and doubletons
+// of the sample), capped at maxVal and dataSize.
+size_t estimateDistinctKeys(const int* data, size_t dataSize, size_t maxVal);
+
+// dense while a private histogram fits in L2 or the estimate fills more than SPARSE_MAX_OCCUPANCY of the bins.
+HistogramOutput selectHistogramOutput(size_t estimatedKeys, size_t maxVal, size_t l2Bytes = machineInfo().l2Bytes);
+
+// checks every entry against truthHistogram and that the counts add up to dataSize. With densify the
+// conversion to testHistogram is part of the timed solve and the dense result is validated instead.
+void profile_threaded_sparse_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           size_t dataSize, size_t maxVal, size_t threadAmount, bool densify, const std::string &testName, size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_SPARSEHISTOGRAM_HPP
@@ -2,21 +2,35 @@
 #define CUDAHISTOGRAMS_TABLESTATS_HPP
 
 #include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <map>
+#include <tuple>
+#include <vector>
 
+#include "BenchmarkStats.hpp"
+#include "PerfCounters.hpp"
 #include "Timer.hpp"
 
 class TimingTablePrinter {
 public:
     static constexpr auto NAME_HEADER   = "Test Name";
     static constexpr auto BIN_HEADER    = "Bin Size";
+    static constexpr auto WORKLOAD_HEADER = "Workload";
     static constexpr auto SIZE_HEADER   = "Elements";
     static constexpr auto TIME_HEADER   = "Time (ms)";
+    static constexpr auto FIRST_HEADER  = "First";
+    static constexpr auto MIN_HEADER    = "Min";
+    static constexpr auto MEDIAN_HEADER = "Median";
+    static constexpr auto MEAN_HEADER   = "Mean";
+    static constexpr auto P95_HEADER    = "P95";
+    static constexpr auto STDDEV_HEADER = "StdDev";
+    static constexpr auto RATE_HEADER   = "Melem/s";
+    static constexpr auto GBS_HEADER    = "GB/s";
     static constexpr auto SPEED_HEADER  = "Speedup (x)";
     static constexpr auto THREAD_HEADER = "Threads";
 
@@ -30,71 +44,120 @@ public:
             return;
         }
 
+        std::map<Key, stats::Summary> summaries;
+        for (const auto& [key, time] : totals()) {
+            summaries[key] = summaryFor(key, time);
+        }
+
         // -----------------------------
         // Build baseline lookup table
         // -----------------------------
-        std::map<std::pair<size_t, size_t>, double> baselineTimes;
+        std::map<std::tuple<size_t, size_t, std::string>, double> baselineTimes;
 
-        for (const auto& [key, time] : totals()) {
+        for (const auto& [key, summary] : summaries) {
             if (key.testName == "Baseline") {
-                baselineTimes[{key.binSize, key.dataSize}] = time;
+                baselineTimes[{key.binSize, key.dataSize, key.workload}] = summary.median;
             }
         }
 
-        size_t nameWidth   = std::strlen(NAME_HEADER);
-        size_t threadWidth = std::strlen(THREAD_HEADER);
-        size_t binWidth    = std::strlen(BIN_HEADER);
-        size_t sizeWidth   = std::strlen(SIZE_HEADER);
-        size_t timeWidth   = std::strlen(TIME_HEADER);
-        size_t speedWidth  = std::strlen(SPEED_HEADER);
-
-        std::map<timing::Key, double> computedSpeedups;
+        std::vector<std::string> headers = {
+            NAME_HEADER, THREAD_HEADER, BIN_HEADER, SIZE_HEADER, WORKLOAD_HEADER, TIME_HEADER, FIRST_HEADER, MIN_HEADER,
+            MEDIAN_HEADER, MEAN_HEADER, P95_HEADER, STDDEV_HEADER, RATE_HEADER, GBS_HEADER, SPEED_HEADER
+        };
+
+        // one column per counter that was captured for at least one test.
+        std::vector<perf::Event> counterColumns;
+        for (size_t e = 0; e < perf::EVENT_COUNT; ++e) {
+            for (const auto& [key, counts] : counters()) {
+                if (counts.valid[e]) {
+                    counterColumns.push_back(static_cast<perf::Event>(e));
+                    headers.emplace_back(perf::eventHeader(static_cast<perf::Event>(e)));
+                    break;
+                }
+            }
+        }
 
-        for (const auto& [key, time] : totals()) {
+        std::vector<std::vector<std::string>> rows;
+        for (const auto& [key, summary] : summaries) {
 
+            // speedup compares medians so a single slow iteration does not move it.
             double speedup = 1.0;
 
             if (key.testName != "Baseline") {
-                if (auto it = baselineTimes.find({key.binSize, key.dataSize});
-                    it != baselineTimes.end() && time > 0.0) {
-                    speedup = it->second / time;
+                if (auto it = baselineTimes.find({key.binSize, key.dataSize, key.workload});
+                    it != baselineTimes.end() && summary.median > 0.0) {
+                    speedup = it->second / summary.median;
                 } else {
                     speedup = 0.0;
                 }
             }
 
-            computedSpeedups[key] = speedup;
+            const double seconds = summary.median / 1000.0;
+            const double elements = static_cast<double>(key.dataSize);
+            const double bytes = elements * static_cast<double>(bytesPerElement(key));
+
+            rows.push_back({
+                key.testName,
+                std::to_string(key.threadCount),
+                std::to_string(key.binSize),
+                std::to_string(key.dataSize),
+                key.workload,
+                formatTime(summary.total),
+                formatTime(summary.first),
+                formatTime(summary.min),
+                formatTime(summary.median),
+                formatTime(summary.mean),
+                formatTime(summary.p95),
+                formatTime(summary.stddev),
+                formatRate(seconds > 0.0 ? elements / seconds / 1e6 : 0.0),
+                formatRate(seconds > 0.0 ? bytes / seconds / 1e9 : 0.0),
+                formatSpeedup(speedup)
+            });
+
+            const auto it = counters().find(key);
+            for (const perf::Event event : counterColumns) {
+                const auto e = static_cast<size_t>(event);
+                rows.back().push_back(it != counters().end() && it->second.valid[e]
+                    ? formatCounter(stats::perElement(it->second.values[e], summary.count, key.dataSize))
+                    : "-");
+            }
+        }
 
-            nameWidth   = std::max(nameWidth, key.testName.size());
-            threadWidth = std::max(threadWidth, std::to_string(key.threadCount).size());
-            binWidth    = std::max(binWidth,  std::to_string(key.binSize).size());
-            sizeWidth   = std::max(sizeWidth, std::to_string(key.dataSize).size());
-            timeWidth   = std::max(timeWidth, formatTime(time).size());
-            speedWidth  = std::max(speedWidth, formatSpeedup(speedup).size());
+        std::vector<size_t> widths(headers.size());
+        for (size_t c = 0; c < headers.size(); ++c) {
+            widths[c] = headers[c].size();
+            for (const auto& row : rows) {
+                widths[c] = std::max(widths[c], row[c].size());
+            }
         }
 
-        const auto separator =
-            makeSeparator(nameWidth, threadWidth, binWidth, sizeWidth, timeWidth, speedWidth);
+        const auto separator = makeSeparator(widths);
 
         os << separator << "\n";
-        printHeader(os, nameWidth, threadWidth, binWidth, sizeWidth, timeWidth, speedWidth);
+        printRow(os, widths, headers);
         os << separator << "\n";
 
-        for (const auto& [key, time] : totals()) {
-            const double speedup = computedSpeedups[key];
-
-            os << "| " << std::left  << std::setw(nameWidth)   << key.testName
-               << " | " << std::right << std::setw(threadWidth) << key.threadCount
-               << " | " << std::right << std::setw(binWidth)    << key.binSize
-               << " | " << std::right << std::setw(sizeWidth)   << key.dataSize
-               << " | " << std::right << std::setw(timeWidth)   << formatTime(time)
-               << " | " << std::right << std::setw(speedWidth)  << formatSpeedup(speedup)
-               << " |\n";
+        for (const auto& row : rows) {
+            printRow(os, widths, row);
         }
 
         os << separator << "\n";
     }
 
+    // callers hold timing::mutex().
+    static stats::Summary summaryFor(const timing::Key& key, const double total) {
+        if (const auto it = timing::samples().find(key); it != timing::samples().end()) {
+            return stats::summarize(it->second);
+        }
+        // totals without samples still print as a single run.
+        return stats::summarize({total});
+    }
+
+    static size_t bytesPerElement(const timing::Key& key) {
+        const auto it = timing::elementBytes().find(key);
+        return it != timing::elementBytes().end() ? it->second : sizeof(int);
+    }
+
 private:
 
     static std::string formatTime(double time) {
@@ -103,44 +166,42 @@ private:
         return oss.str();
     }
 
+    static std::string formatRate(double rate) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << rate;
+        return oss.str();
+    }
+
+    static std::string formatCounter(double rate) {
+        std::ostringstream oss;
+        oss << std::setprecision(3) << rate;
+        return oss.str();
+    }
+
     static std::string formatSpeedup(double speed) {
         std::ostringstream oss;
         oss << std::fixed << std::setprecision(2) << speed << "x";
         return oss.str();
     }
 
-    static std::string makeSeparator(const size_t nameW,
-                                     const size_t threadW,
-                                     const size_t binW,
-                                     const size_t sizeW,
-                                     const size_t timeW,
-                                     const size_t speedW) {
-        return "+"
-             + std::string(nameW + 2, '-')
-             + "+" + std::string(threadW + 2, '-')
-             + "+" + std::string(binW + 2, '-')
-             + "+" + std::string(sizeW + 2, '-')
-             + "+" + std::string(timeW + 2, '-')
-             + "+" + std::string(speedW + 2, '-')
-             + "+";
+    static std::string makeSeparator(const std::vector<size_t>& widths) {
+        std::string separator = "+";
+        for (const size_t w : widths) {
+            separator += std::string(w + 2, '-') + "+";
+        }
+        return separator;
     }
 
-    static void printHeader(std::ostream& os,
-                            const size_t nameW,
-                            const size_t threadW,
-                            const size_t binW,
-                            const size_t sizeW,
-                            const size_t timeW,
-                            const size_t speedW) {
-        os
-            << "| " << std::left  << std::setw(nameW)   << NAME_HEADER
-            << " | " << std::right << std::setw(threadW) << THREAD_HEADER
-            << " | " << std::right << std::setw(binW)    << BIN_HEADER
-            << " | " << std::right << std::setw(sizeW)   << SIZE_HEADER
-            << " | " << std::right << std::setw(timeW)   << TIME_HEADER
-            << " | " << std::right << std::setw(speedW)  << SPEED_HEADER
-            << " |\n";
+    // the test name is left aligned, every numeric column is right aligned.
+    static void printRow(std::ostream& os,
+                         const std::vector<size_t>& widths,
+                         const std::vector<std::string>& cells) {
+        os << "| " << std::left << std::setw(widths[0]) << cells[0];
+        for (size_t c = 1; c < cells.size(); ++c) {
+            os << " | " << std::right << std::setw(widths[c]) << cells[c];
+        }
+        os << " |\n";
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,165 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "ThreadPlacement.hpp"
+
+#include <map>
+#include <set>
+#include <tuple>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    // physical cores first, then the second sibling of every core and so on.
+    std::vector<LogicalCpu> siblingsLast(std::vector<LogicalCpu> cpus) {
+        std::map<size_t, size_t> seen;
+        std::vector<std::pair<size_t, LogicalCpu>> ranked;
+        for (const LogicalCpu& cpu : cpus) {
+            ranked.emplace_back(seen[cpu.core]++, cpu);
+        }
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+            return std::tie(a.first, a.second.node, a.second.core) < std::tie(b.first, b.second.node, b.second.core);
+        });
+        cpus.clear();
+        for (const auto& [rank, cpu] : ranked) {
+            cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    const std::vector<size_t>& cachedOrder(const PlacementPolicy policy) {
+        static const std::vector<size_t> orders[] = {
+            {}, placementOrder(PlacementPolicy::Compact), placementOrder(PlacementPolicy::Scatter), placementOrder(PlacementPolicy::PhysicalCores)
+        };
+        return orders[static_cast<size_t>(policy)];
+    }
+}
+
+const char* placementPolicyName(const PlacementPolicy policy) {
+    switch (policy) {
+        case PlacementPolicy::Compact:       return "Compact";
+        case PlacementPolicy::Scatter:       return "Scatter";
+        case PlacementPolicy::PhysicalCores: return "Physical Cores";
+        default:                             return "None";
+    }
+}
+
+std::vector<size_t> placementOrder(const PlacementPolicy policy, const MachineInfo& machine) {
+    std::vector<LogicalCpu> cpus = machine.cpus;
+
+    switch (policy) {
+        case PlacementPolicy::Compact:
+            std::stable_sort(cpus.begin(), cpus.end(), [](const LogicalCpu& a, const LogicalCpu& b) {
+                return std::tie(a.node, a.package, a.core, a.id) < std::tie(b.node, b.package, b.core, b.id);
+            });
+            break;
+        case PlacementPolicy::PhysicalCores:
+            cpus = siblingsLast(std::move(cpus));
+            break;
+        case PlacementPolicy::Scatter: {
+            // deal the physical-first order of every node out like cards.
+            std::map<size_t, std::vector<LogicalCpu>> perNode;
+            for (const LogicalCpu& cpu : siblingsLast(std::move(cpus))) {
+                perNode[cpu.node].push_back(cpu);
+            }
+            cpus.clear();
+            for (size_t i = 0;; ++i) {
+                bool any = false;
+                for (const auto& [node, list] : perNode) {
+                    if (i < list.size()) {
+                        cpus.push_back(list[i]);
+                        any = true;
+                    }
+                }
+                if (!any) break;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    std::vector<size_t> order;
+    for (const LogicalCpu& cpu : cpus) {
+        order.push_back(cpu.id);
+    }
+    return order;
+}
+
+std::vector<size_t> cpuNodes(const MachineInfo& machine) {
+    std::set<size_t> nodes;
+    for (const LogicalCpu& cpu : machine.cpus) {
+        nodes.insert(cpu.node);
+    }
+    return {nodes.begin(), nodes.end()};
+}
+
+#if defined(_WIN32)
+bool pinToNode(const size_t node, const MachineInfo& machine) {
+    DWORD_PTR mask = 0;
+    for (const LogicalCpu& cpu : machine.cpus) {
+        if (cpu.node == node && cpu.id < sizeof(DWORD_PTR) * 8) mask |= DWORD_PTR{1} << cpu.id;
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+struct PlacementScope::Saved {
+    DWORD_PTR mask = 0;
+};
+
+PlacementScope::PlacementScope(const PlacementPolicy policy, const size_t index) {
+    if (policy == PlacementPolicy::None) return;
+    const auto& order = cachedOrder(policy);
+    if (order.empty()) return;
+
+    const DWORD_PTR previous = SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << order[index % order.size()]);
+    if (previous != 0) saved = std::make_unique<Saved>(Saved{previous});
+}
+
+PlacementScope::~PlacementScope() {
+    if (saved) SetThreadAffinityMask(GetCurrentThread(), saved->mask);
+}
+#else
+bool pinToNode(const size_t node, const MachineInfo& machine) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    bool any = false;
+    for (const LogicalCpu& cpu : machine.cpus) {
+        if (cpu.node == node && cpu.id < CPU_SETSIZE) {
+            CPU_SET(cpu.id, &mask);
+            any = true;
+        }
+    }
+    return any && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) == 0;
+}
+
+struct PlacementScope::Saved {
+    cpu_set_t mask;
+};
+
+PlacementScope::PlacementScope(const PlacementPolicy policy, const size_t index) {
+    if (policy == PlacementPolicy::None) return;
+    const auto& order = cachedOrder(policy);
+    if (order.empty()) return;
+
+    auto previous = std::make_unique<Saved>();
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &previous->mask) != 0) return;
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(order[index % order.size()], &mask);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) == 0) {
+        saved = std::move(previous);
+    }
+}
+
+PlacementScope::~PlacementScope() {
+    if (saved) pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &saved->mask);
+}
+#endif
@@ -0,0 +1,79 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_THREADPLACEMENT_HPP
+#define CUDAHISTOGRAMS_THREADPLACEMENT_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common.hpp"
+#include "MachineInfo.hpp"
+
+enum class PlacementPolicy {
+    None,           // leave it to the scheduler
+    Compact,        // fill a node core by core, SMT siblings next to each other
+    Scatter,        // round robin over NUMA nodes, physical cores before their siblings
+    PhysicalCores   // one thread per physical core, siblings only once every core has one
+};
+
+const char* placementPolicyName(PlacementPolicy policy);
+
+// logical cpu id for every worker index, index t runs on order[t % order.size()].
+std::vector<size_t> placementOrder(PlacementPolicy policy, const MachineInfo& machine = machineInfo());
+
+// NUMA nodes that have at least one online cpu, ascending.
+std::vector<size_t> cpuNodes(const MachineInfo& machine = machineInfo());
+
+// Pins the calling thread to every cpu of node for good. Threads it starts afterwards inherit the mask and
+// first touch puts their pages on that node. False if the node has no cpus or the OS refuses.
+bool pinToNode(size_t node, const MachineInfo& machine = machineInfo());
+
+// Pins the calling thread to the cpu the policy gives worker index and puts the previous affinity back on
+// destruction, so pool threads are free again for whatever runs on them next. No-op for None.
+class PlacementScope {
+    struct Saved;
+    std::unique_ptr<Saved> saved;
+public:
+    PlacementScope(PlacementPolicy policy, size_t index);
+    ~PlacementScope();
+    PlacementScope(const PlacementScope&) = delete;
+    PlacementScope& operator=(const PlacementScope&) = delete;
+};
+
+// runs fn(t) for t in [0, threadAmount) with each task pinned as worker t.
+template<typename Pool, typename F>
+void runPlaced(const PlacementPolicy policy, const size_t threadAmount, Pool& pool, F&& fn) {
+    pool.parallel_for(0, threadAmount, 1, [policy, &fn](const size_t t) {
+        PlacementScope scope(policy, t);
+        fn(t);
+    }).wait();
+}
+
+// page aligned copy of src where worker t writes [t * per, (t + 1) * per) itself, so under first touch each
+// range lands on the node of the cpu that will read it. Same split as the threaded solvers.
+template<typename T, typename Pool>
+std::shared_ptr<T[]> firstTouchCopy(const std::shared_ptr<T[]>& src, const size_t count, const size_t threadAmount,
+                                    const PlacementPolicy policy, Pool& pool) {
+    std::shared_ptr<T[]> placed = makeAlignedArray<T>(std::max<size_t>(count, 1), systemPageSize());
+    const size_t perThread = (count + threadAmount - 1) / threadAmount;
+    runPlaced(policy, threadAmount, pool, [&](const size_t t) {
+        const size_t begin = std::min(t * perThread, count);
+        const size_t end   = std::min(begin + perThread, count);
+        std::memcpy(placed.get() + begin, src.get() + begin, (end - begin) * sizeof(T));
+    });
+    return placed;
+}
+
+// zeroes threadAmount slices of perThread elements, each by its own placed worker.
+template<typename T, typename Pool>
+void firstTouchZero(T* slices, const size_t perThread, const size_t threadAmount, const PlacementPolicy policy, Pool& pool) {
+    runPlaced(policy, threadAmount, pool, [=](const size_t t) {
+        std::memset(slices + t * perThread, 0, perThread * sizeof(T));
+    });
+}
+
+#endif //CUDAHISTOGRAMS_THREADPLACEMENT_HPP
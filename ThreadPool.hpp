@@ -5,10 +5,32 @@
 #ifndef CUDAHISTOGRAMS_THREADPOOL_HPP
 #define CUDAHISTOGRAMS_THREADPOOL_HPP
 
+#include <algorithm>
 #include <any>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
 #include <queue>
+#include <vector>
+
+#include "PhaseTrace.hpp"
+
+// parallel_for bodies either take a single index or a [begin, end) chunk.
+template<typename F>
+void invokeRange(F& fn, const size_t begin, const size_t end) {
+    if constexpr (std::is_invocable_v<F&, size_t, size_t>) {
+        fn(begin, end);
+    } else {
+        for (size_t i = begin; i < end; ++i) {
+            fn(i);
+        }
+    }
+}
 
 class ThreadPool {
     const size_t numThreads;
@@ -19,8 +41,27 @@ class ThreadPool {
     std::mutex mutex;
 
     bool isShutdown = false;
+
+    static size_t& workerIndex() {
+        thread_local size_t idx = SIZE_MAX;
+        return idx;
+    }
 public:
+    // completion handle for every task queued by one parallel_for.
+    class BulkHandle {
+        friend class ThreadPool;
+        std::vector<std::future<void>> futures;
+    public:
+        void wait() {
+            for (auto& future : futures) {
+                future.get();
+            }
+            futures.clear();
+        }
+    };
+
     void work(size_t threadIdx) {
+        workerIndex() = threadIdx;
         std::unique_lock lock(mutex);
 
         while (!isShutdown) {
@@ -44,16 +85,39 @@ public:
         }
     }
 
+    size_t size() const { return numThreads; }
+
+    // index of the calling worker in [0, size()), SIZE_MAX outside the pool.
+    static size_t currentWorker() { return workerIndex(); }
+
+    // queues one task per grain sized chunk of [begin, end), each runs fn(i) or fn(chunkBegin, chunkEnd).
+    template<typename F>
+    BulkHandle parallel_for(const size_t begin, const size_t end, size_t grain, F&& fn) {
+        grain = std::max<size_t>(grain, 1);
+        auto shared = std::make_shared<std::decay_t<F>>(std::forward<F>(fn));
+
+        BulkHandle handle;
+        for (size_t chunk = begin; chunk < end; chunk += grain) {
+            const size_t chunkEnd = std::min(chunk + grain, end);
+            handle.futures.push_back(queue([shared, chunk, chunkEnd]() {
+                invokeRange(*shared, chunk, chunkEnd);
+            }));
+        }
+        return handle;
+    }
+
     template<typename F>
     auto queue(F&& f) {
         using R = std::invoke_result_t<F>;
 
         auto p = std::make_shared<std::promise<R>>();
         auto future = p->get_future();
+        const uint64_t queuedAt = trace::enabled() ? trace::now() : 0;
 
         {
             std::unique_lock lock(mutex);
-            tasks.push([p, f = std::forward<F>(f)]() mutable {
+            tasks.push([p, queuedAt, f = std::forward<F>(f)]() mutable {
+                if (queuedAt) trace::record(trace::Phase::Queue, queuedAt, trace::now());
                 try {
                     if constexpr (std::is_void_v<R>) {
                         f();
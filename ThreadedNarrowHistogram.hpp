@@ -0,0 +1,173 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_THREADEDNARROWHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_THREADEDNARROWHISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "Common.hpp"
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadPool.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+// defaults until the real sizes are known, per core.
+constexpr size_t DEFAULT_L1D_BYTES = 32 * 1024;
+constexpr size_t DEFAULT_L2_BYTES  = 1024 * 1024;
+
+enum class CounterWidth {
+    U8,
+    U16,
+    U32
+};
+
+// how narrow counters are kept from overflowing into the wide int32 spill histogram.
+enum class NarrowFlush {
+    ElementBudget, // flush every bin after max(Counter) elements, cheap when bins << budget
+    Saturation     // a counter that wraps spills 2^bits into its wide bin on the spot
+};
+
+inline const char* counterWidthName(const CounterWidth width) {
+    switch (width) {
+        case CounterWidth::U8:  return "u8";
+        case CounterWidth::U16: return "u16";
+        default:                return "u32";
+    }
+}
+
+inline const char* narrowFlushName(const NarrowFlush flush) {
+    return flush == NarrowFlush::ElementBudget ? "budget" : "saturation";
+}
+
+// int32 when the plain private histogram already sits in L1, otherwise the widest compact counter that
+// brings the hot histogram into L1, then into L2.
+inline CounterWidth selectCounterWidth(const size_t maxVal, const size_t l1Bytes = DEFAULT_L1D_BYTES, const size_t l2Bytes = DEFAULT_L2_BYTES) {
+    if (maxVal * sizeof(uint32_t) <= l1Bytes) return CounterWidth::U32;
+    if (maxVal * sizeof(uint16_t) <= l1Bytes) return CounterWidth::U16;
+    if (maxVal * sizeof(uint8_t)  <= l1Bytes) return CounterWidth::U8;
+    if (maxVal * sizeof(uint16_t) <= l2Bytes) return CounterWidth::U16;
+    return CounterWidth::U8;
+}
+
+// a full flush costs maxVal adds, only worth it if it happens rarely relative to the elements it covers.
+inline NarrowFlush selectNarrowFlush(const CounterWidth width, const size_t maxVal) {
+    const size_t budget = width == CounterWidth::U8 ? std::numeric_limits<uint8_t>::max() : std::numeric_limits<uint16_t>::max();
+    return maxVal * 16 <= budget ? NarrowFlush::ElementBudget : NarrowFlush::Saturation;
+}
+
+// Reduced solver over Counter sized private histograms. Thread t owns narrow[t * perThreadCounters, +maxVal)
+// for the hot loop and wide[t * perThreadInts, +maxVal) that the narrow counters spill into, the wide
+// histograms are then reduced bin sliced. With uint32_t counters there is nothing to spill and the narrow
+// histograms are reduced directly.
+template<typename Counter, NarrowFlush Flush = NarrowFlush::Saturation, typename Pool = ThreadPool>
+void solveThreadedNarrowHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram,
+    const std::shared_ptr<Counter[]>& narrow, const std::shared_ptr<int[]>& wide,
+    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const size_t perThreadCounters, const size_t perThreadInts, Pool& pool) {
+    static_assert(std::is_same_v<Counter, uint8_t> || std::is_same_v<Counter, uint16_t> || std::is_same_v<Counter, uint32_t>);
+    constexpr bool needsSpill = sizeof(Counter) < sizeof(int);
+    constexpr size_t budget = std::numeric_limits<Counter>::max();
+
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &data, &narrow, &wide](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        Counter* counters = narrow.get() + t * perThreadCounters;
+        int* spill = wide.get() + t * perThreadInts;
+        std::fill_n(counters, maxVal, Counter{0});
+
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+
+        if constexpr (!needsSpill) {
+            for (size_t i = start; i < end; ++i) {
+                ++counters[data[i]];
+            }
+        } else if constexpr (Flush == NarrowFlush::ElementBudget) {
+            std::fill_n(spill, maxVal, 0);
+            for (size_t blockStart = start; blockStart < end; blockStart += budget) {
+                const size_t blockEnd = std::min(blockStart + budget, end);
+                for (size_t i = blockStart; i < blockEnd; ++i) {
+                    ++counters[data[i]];
+                }
+                for (size_t b = 0; b < maxVal; ++b) {
+                    spill[b] += counters[b];
+                    counters[b] = 0;
+                }
+            }
+        } else {
+            std::fill_n(spill, maxVal, 0);
+            for (size_t i = start; i < end; ++i) {
+                const int value = data[i];
+                // unsigned wrap back to zero means the counter just held 2^bits increments.
+                if (++counters[value] == 0) [[unlikely]] {
+                    spill[value] += static_cast<int>(budget) + 1;
+                }
+            }
+            for (size_t b = 0; b < maxVal; ++b) {
+                spill[b] += counters[b];
+            }
+        }
+    }).wait();
+
+    if constexpr (needsSpill) {
+        reduceBinSliced(wide.get(), perThreadInts, threadAmount, histogram, maxVal, threadAmount, pool);
+    } else {
+        reduceBinSliced(reinterpret_cast<const int*>(narrow.get()), perThreadCounters, threadAmount, histogram, maxVal, threadAmount, pool);
+    }
+}
+
+template<typename Counter, NarrowFlush Flush = NarrowFlush::Saturation, typename Pool = ThreadPool>
+void profile_threaded_narrow_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                           const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, Pool& pool) {
+    const size_t pageSize = systemPageSize();
+    const size_t perThreadCounters = (maxVal * sizeof(Counter) + pageSize - 1) / pageSize * pageSize / sizeof(Counter);
+    const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, pageSize) / sizeof(int);
+
+    const std::shared_ptr<Counter[]> narrow = makeAlignedArray<Counter>(perThreadCounters * threadAmount, pageSize);
+    // the uint32_t path never spills, so it doesn't need the wide histograms.
+    const std::shared_ptr<int[]> wide = makeAlignedArray<int>(sizeof(Counter) < sizeof(int) ? perThreadInts * threadAmount : 1, pageSize);
+
+    // warmup
+    solveThreadedNarrowHistogram<Counter, Flush>(data, testHistogram, narrow, wide, dataSize, maxVal, threadAmount, perThreadCounters, perThreadInts, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveThreadedNarrowHistogram<Counter, Flush>(data, testHistogram, narrow, wide, dataSize, maxVal, threadAmount, perThreadCounters, perThreadInts, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
+
+// picks counter width and flush policy from the cache sizes, the default way to run the compact solver.
+template<typename Pool = ThreadPool>
+void profile_threaded_compact_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                            const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, Pool& pool,
+                                            const size_t l1Bytes = DEFAULT_L1D_BYTES, const size_t l2Bytes = DEFAULT_L2_BYTES) {
+    const CounterWidth width = selectCounterWidth(maxVal, l1Bytes, l2Bytes);
+    const NarrowFlush flush = selectNarrowFlush(width, maxVal);
+    const std::string name = testName + " (" + counterWidthName(width) + (width == CounterWidth::U32 ? "" : std::string("/") + narrowFlushName(flush)) + ")";
+
+    const auto run = [&]<typename Counter>() {
+        if (flush == NarrowFlush::ElementBudget) {
+            profile_threaded_narrow_cpu_histogram<Counter, NarrowFlush::ElementBudget>(data, truthHistogram, testHistogram, dataSize, maxVal, threadAmount, name, iterations, pool);
+        } else {
+            profile_threaded_narrow_cpu_histogram<Counter, NarrowFlush::Saturation>(data, truthHistogram, testHistogram, dataSize, maxVal, threadAmount, name, iterations, pool);
+        }
+    };
+
+    switch (width) {
+        case CounterWidth::U8:  run.template operator()<uint8_t>();  break;
+        case CounterWidth::U16: run.template operator()<uint16_t>(); break;
+        case CounterWidth::U32: run.template operator()<uint32_t>(); break;
+    }
+}
+
+#endif //CUDAHISTOGRAMS_THREADEDNARROWHISTOGRAM_HPP
@@ -6,59 +6,135 @@
 #define CUDAHISTOGRAMS_THREADEDREDUCEDHISTOGRAM_HPP
 #include <barrier>
 #include <cassert>
+#include <cstring>
 #include <future>
 #include <immintrin.h>
 #include <malloc.h>
 #include <memory>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
+#if defined(_WIN32)
 #include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "Common.hpp"
+#include "PhaseTrace.hpp"
 #include "Timer.hpp"
+#include "ThreadPlacement.hpp"
 #include "ThreadPool.hpp"
 
 
+// naive pins kept for the original Pin_Threads/AMD rows, the topology aware ones are in ThreadPlacement.hpp.
 inline void pinThreadToCore(int core_id)
 {
+#if defined(_WIN32)
     DWORD_PTR mask = (1ULL << core_id);
     HANDLE thread = GetCurrentThread();
     SetThreadAffinityMask(thread, mask);
+#else
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(core_id, &mask);
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+#endif
 }
 
 inline void setThreadCoreAffinity(size_t threadIndex) {
-    const DWORD_PTR mask = 1ULL << (threadIndex % 8);
-    SetThreadAffinityMask(GetCurrentThread(), mask);
+    pinThreadToCore(static_cast<int>(threadIndex % 8));
 }
 
-template<bool AMD_Thread_Affinity_Test = false, bool Explicit_Prefetch_Test = false, bool Unrolling_Test = false, bool Pin_Threads = false>
+// bytes of one private histogram: maxVal counters rounded up to whole cache lines, then to a whole page
+// so no two threads ever share a page.
+inline size_t reducedPerThreadBytesPaged(const size_t maxVal, const size_t pageSize) {
+    constexpr size_t elementsPerCacheLine = std::hardware_destructive_interference_size / sizeof(int);
+    const size_t cacheLinesPerThread = (maxVal + elementsPerCacheLine - 1) / elementsPerCacheLine;
+
+    const size_t perThreadBytes = cacheLinesPerThread * elementsPerCacheLine * sizeof(int);
+    return (perThreadBytes + pageSize - 1) & ~(pageSize - 1);
+}
+
+// single pass reduction: every task owns a cache line aligned slice of bins and sums it across all
+// privateCount histograms (perThreadInts apart), writing straight into histogram. Works for any thread count.
+// With Clear every private counter is zeroed right after it is read, leaving the private histograms ready
+// for the next solve without a separate clearing pass.
+template<bool Clear = false, typename H, typename Pool = ThreadPool>
+void reduceBinSliced(std::conditional_t<Clear, int*, const int*> privateHistograms, const size_t perThreadInts, const size_t privateCount,
+    const H& histogram, const size_t maxVal, const size_t threadAmount, Pool& pool) {
+    constexpr size_t binsPerCacheLine = std::hardware_destructive_interference_size / sizeof(int);
+    const size_t binsPerThread = ((maxVal + threadAmount - 1) / threadAmount + binsPerCacheLine - 1) & ~(binsPerCacheLine - 1);
+
+    pool.parallel_for(0, threadAmount, 1, [=, &histogram](const size_t t) {
+        trace::Scope scope(trace::Phase::Reduce);
+        const size_t begin = std::min(t * binsPerThread, maxVal);
+        const size_t end   = std::min(begin + binsPerThread, maxVal);
+        for (size_t b = begin; b < end; ++b) {
+            int sum = 0;
+            for (size_t s = 0; s < privateCount; ++s) {
+                sum += privateHistograms[s * perThreadInts + b];
+                if constexpr (Clear) {
+                    privateHistograms[s * perThreadInts + b] = 0;
+                }
+            }
+            histogram[b] = sum;
+        }
+    }).wait();
+}
+
+enum class ReductionStrategy {
+    Tree,       // log2 rounds of pairwise adds between barriers, needs a power of two thread count
+    BinSliced   // one pass, every thread sums its own slice of bins across all private histograms
+};
+
+struct ReducedPhaseTimes {
+    double countMs = 0.0;
+    double reduceMs = 0.0;
+};
+
+template<bool AMD_Thread_Affinity_Test = false, bool Explicit_Prefetch_Test = false, bool Unrolling_Test = false, bool Pin_Threads = false,
+         ReductionStrategy Reduction = ReductionStrategy::Tree, PlacementPolicy Placement = PlacementPolicy::None, typename Pool = ThreadPool>
 void solveThreadedReducedHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& reducedHistogram,
-    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const size_t pageSize, const size_t reducedSize, const size_t perThreadBytesPaged, ThreadPool& pool) {
+    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const size_t pageSize, const size_t reducedSize, const size_t perThreadBytesPaged, Pool& pool,
+    ReducedPhaseTimes* phases = nullptr) {
     static_assert(!(AMD_Thread_Affinity_Test && Pin_Threads));
-    assert(threadAmount != 0 && (threadAmount & (threadAmount - 1)) == 0);
+    static_assert(Placement == PlacementPolicy::None || !(AMD_Thread_Affinity_Test || Pin_Threads));
+    if constexpr (Reduction == ReductionStrategy::Tree) {
+        assert(threadAmount != 0 && (threadAmount & (threadAmount - 1)) == 0);
+    }
     std::vector<std::thread> threads;
 
     const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+    constexpr size_t binsPerCacheLine = std::hardware_destructive_interference_size / sizeof(int);
+    const size_t binsPerThread = ((maxVal + threadAmount - 1) / threadAmount + binsPerCacheLine - 1) & ~(binsPerCacheLine - 1);
+
+    const timing::time_point solveStart = timing::clock::now();
+    timing::time_point countEnd = solveStart;
 
-    std::vector<std::future<void>> futures;
     std::barrier barrier(threadAmount);
-    for (size_t t = 0; t < threadAmount; ++t) {
-        futures.push_back(pool.queue([=, &data, &reducedHistogram, &barrier]() {
-            if constexpr (AMD_Thread_Affinity_Test) {
-                setThreadCoreAffinity(t);
-            }
+    // every index is one worker, they meet at the barrier so the pool needs at least threadAmount threads.
+    pool.parallel_for(0, threadAmount, 1, [=, &data, &histogram, &reducedHistogram, &barrier, &countEnd](const size_t t) {
+        if constexpr (AMD_Thread_Affinity_Test) {
+            setThreadCoreAffinity(t);
+        }
 
-            if constexpr (Pin_Threads) {
-                pinThreadToCore(t);
-            }
+        if constexpr (Pin_Threads) {
+            pinThreadToCore(t);
+        }
+
+        PlacementScope placement(Placement, t);
 
-            const size_t threadOffset = t * (perThreadBytesPaged / sizeof(int));
-            const size_t start = t * elementsPerThread;
-            const size_t end   = std::min(start + elementsPerThread, dataSize);
-            const size_t count = end - start;
+        const size_t threadOffset = t * (perThreadBytesPaged / sizeof(int));
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        const size_t count = end - start;
 
-            // initial reduction. All threads perform this
+        // initial reduction. All threads perform this
+        {
+            trace::Scope countScope(trace::Phase::Count);
             if constexpr (Unrolling_Test) {
                 for (size_t i = 0; i < count; i+=4) {
                     for (size_t k = 0; k < 4 && i + k < count; ++k) {
@@ -84,69 +160,145 @@ void solveThreadedReducedHistogram(const std::shared_ptr<int[]>& data, const std
                     ++reducedHistogram[idx];
                 }
             }
+        }
+
+        if constexpr (Reduction == ReductionStrategy::BinSliced) {
+            {
+                trace::Scope barrierScope(trace::Phase::Barrier);
+                barrier.arrive_and_wait();
+            }
+            if (t == 0) countEnd = timing::clock::now();
+
+            trace::Scope reduceScope(trace::Phase::Reduce);
+
+            const size_t perThreadInts = perThreadBytesPaged / sizeof(int);
+            const size_t binBegin = std::min(t * binsPerThread, maxVal);
+            const size_t binEnd   = std::min(binBegin + binsPerThread, maxVal);
+            for (size_t b = binBegin; b < binEnd; ++b) {
+                int sum = 0;
+                for (size_t s = 0; s < threadAmount; ++s) {
+                    sum += reducedHistogram[s * perThreadInts + b];
+                }
+                histogram[b] = sum;
+            }
+            return;
+        }
 
-            size_t reductionThreads = threadAmount / 2;
+        size_t reductionThreads = threadAmount / 2;
+        {
+            trace::Scope barrierScope(trace::Phase::Barrier);
             barrier.arrive_and_wait();
-            while (t < reductionThreads) {
+        }
+        if (t == 0) countEnd = timing::clock::now();
+        while (t < reductionThreads) {
+            {
+                trace::Scope reduceScope(trace::Phase::Reduce);
                 for (size_t i = 0; i < maxVal; ++i) {
                     reducedHistogram[threadOffset + i] +=  reducedHistogram[(t + reductionThreads) * (perThreadBytesPaged / sizeof(int)) + i];
                 }
-
-                reductionThreads = reductionThreads / 2;
-                barrier.arrive_and_wait();
             }
-            barrier.arrive_and_drop();
-        }));
-    }
 
-    for (auto& future : futures) {
-        future.get();
+            reductionThreads = reductionThreads / 2;
+            trace::Scope barrierScope(trace::Phase::Barrier);
+            barrier.arrive_and_wait();
+        }
+        barrier.arrive_and_drop();
+    }).wait();
+
+    if constexpr (Reduction == ReductionStrategy::Tree) {
+        for (size_t i = 0; i < maxVal; ++i) {
+            histogram[i] = reducedHistogram[i];
+        }
     }
 
-    for (size_t i = 0; i < maxVal; ++i) {
-        histogram[i] = reducedHistogram[i];
+    if (phases) {
+        phases->countMs  = std::chrono::duration<double, std::milli>(countEnd - solveStart).count();
+        phases->reduceMs = std::chrono::duration<double, std::milli>(timing::clock::now() - countEnd).count();
     }
 }
 
 
 
-template<bool AMD_Thread_Affinity_Test = false, bool Explicit_Prefetch_Test = false, bool Unrolling_Test = false, bool Pin_Threads = false>
-void profile_threaded_reduced_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
-                                                   const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, ThreadPool& pool) {
-    SYSTEM_INFO si;
-    GetSystemInfo(&si);
-    const size_t pageSize = si.dwPageSize;
-
-    constexpr size_t cacheLineBytes = std::hardware_destructive_interference_size;
-    constexpr size_t elementsPerCacheLine = cacheLineBytes / sizeof(int);
-    const size_t cacheLinesPerThread = (maxVal + elementsPerCacheLine - 1) / elementsPerCacheLine;
-
-    const size_t perThreadBytes = cacheLinesPerThread * elementsPerCacheLine * sizeof(int);
-    const size_t perThreadBytesPaged = (perThreadBytes + pageSize - 1) & ~(pageSize - 1);
+// with a placement policy every worker first touches its own private histogram, and on a multi node machine
+// its own slice of a copy of the input, so both land on its local node. The copy doubles the input's memory
+// for the duration of the call.
+template<bool AMD_Thread_Affinity_Test = false, bool Explicit_Prefetch_Test = false, bool Unrolling_Test = false, bool Pin_Threads = false,
+         ReductionStrategy Reduction = ReductionStrategy::Tree, PlacementPolicy Placement = PlacementPolicy::None, typename Pool = ThreadPool>
+void profile_threaded_reduced_cpu_histogram(const std::shared_ptr<int[]> &sourceData, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                                   const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations, Pool& pool) {
+    const size_t pageSize = systemPageSize();
+    const size_t perThreadBytesPaged = reducedPerThreadBytesPaged(maxVal, pageSize);
 
     const size_t reducedSize = perThreadBytesPaged * threadAmount;
 
+    const std::shared_ptr<int[]> reducedHistogram = makeAlignedArray<int>(reducedSize / sizeof(int), pageSize);
 
-    const std::shared_ptr<int[]> reducedHistogram(static_cast<int*>(_aligned_malloc(reducedSize, cacheLineBytes)),[](int* p) { _aligned_free(p);});
+    std::shared_ptr<int[]> data = sourceData;
+    if constexpr (Placement != PlacementPolicy::None) {
+        firstTouchZero(reducedHistogram.get(), perThreadBytesPaged / sizeof(int), threadAmount, Placement, pool);
+        if (machineInfo().numaNodes > 1) {
+            data = firstTouchCopy(sourceData, dataSize, threadAmount, Placement, pool);
+        }
+    }
 
     // pre_touch(data.get(), dataSize);
     // pre_touch(testHistogram.get(), maxVal);
     // pre_touch(reducedHistogram.get(), reducedSize / sizeof(int));
 
     // warmup
-    solveThreadedReducedHistogram<AMD_Thread_Affinity_Test, Explicit_Prefetch_Test, Unrolling_Test, Pin_Threads>(data, testHistogram, reducedHistogram,
+    solveThreadedReducedHistogram<AMD_Thread_Affinity_Test, Explicit_Prefetch_Test, Unrolling_Test, Pin_Threads, Reduction, Placement>(data, testHistogram, reducedHistogram,
             dataSize, static_cast<size_t>(maxVal), threadAmount, pageSize, reducedSize, perThreadBytesPaged, pool);
 
     for (size_t i = 0; i < iterations; ++i) {
         memset(reducedHistogram.get(), 0, reducedSize);
         clear(testHistogram.get(), maxVal); // clear last test if any.
+        ReducedPhaseTimes phases;
         TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
-        solveThreadedReducedHistogram<AMD_Thread_Affinity_Test, Explicit_Prefetch_Test, Unrolling_Test, Pin_Threads>(data, testHistogram, reducedHistogram,
-            dataSize, maxVal, threadAmount, pageSize, reducedSize, perThreadBytesPaged, pool);
+        solveThreadedReducedHistogram<AMD_Thread_Affinity_Test, Explicit_Prefetch_Test, Unrolling_Test, Pin_Threads, Reduction, Placement>(data, testHistogram, reducedHistogram,
+            dataSize, maxVal, threadAmount, pageSize, reducedSize, perThreadBytesPaged, pool, &phases);
         TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        timing::record({testName + " [count phase]", static_cast<size_t>(maxVal), dataSize, threadAmount}, phases.countMs);
+        timing::record({testName + " [reduce phase]", static_cast<size_t>(maxVal), dataSize, threadAmount}, phases.reduceMs);
         validate(truthHistogram, testHistogram, maxVal);
     }
 }
 
 
+// fine grained variant for comparing pools: the input is cut into grain sized chunks that any worker may
+// pick up, each chunk counts into the private histogram of the worker running it, then a bin sliced reduction.
+template<typename Pool>
+void solveThreadedGrainedHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<int[]>& histogram, const std::shared_ptr<int[]>& reducedHistogram,
+    const size_t dataSize, const size_t maxVal, const size_t grain, const size_t perThreadInts, Pool& pool) {
+    pool.parallel_for(0, dataSize, grain, [&data, &reducedHistogram, perThreadInts](const size_t begin, const size_t end) {
+        trace::Scope scope(trace::Phase::Count);
+        int* hist = reducedHistogram.get() + Pool::currentWorker() * perThreadInts;
+        for (size_t i = begin; i < end; ++i) {
+            ++hist[data[i]];
+        }
+    }).wait();
+
+    reduceBinSliced(reducedHistogram.get(), perThreadInts, pool.size(), histogram, maxVal, pool.size(), pool);
+}
+
+template<typename Pool>
+void profile_threaded_grained_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                            const size_t dataSize, const int maxVal, const size_t grain, const std::string &testName, const size_t iterations, Pool& pool) {
+    const size_t perThreadInts = reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int);
+    const size_t reducedInts = perThreadInts * pool.size();
+    const std::shared_ptr<int[]> reducedHistogram = makeAlignedArray<int>(reducedInts, systemPageSize());
+    clear(reducedHistogram.get(), reducedInts);
+
+    // warmup
+    solveThreadedGrainedHistogram(data, testHistogram, reducedHistogram, dataSize, maxVal, grain, perThreadInts, pool);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(reducedHistogram.get(), reducedInts);
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, pool.size());
+        solveThreadedGrainedHistogram(data, testHistogram, reducedHistogram, dataSize, maxVal, grain, perThreadInts, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, pool.size());
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
+
 #endif //CUDAHISTOGRAMS_THREADEDREDUCEDHISTOGRAM_HPP
\ No newline at end of file
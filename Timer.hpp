@@ -6,21 +6,32 @@
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <vector>
+
+#include "PerfCounters.hpp"
+#include "PhaseTrace.hpp"
 
 namespace timing {
 
     using clock = std::chrono::high_resolution_clock;
     using time_point = clock::time_point;
 
+    // input distribution of whatever is timed next, set by the benchmark driver before generating data.
+    inline std::string& currentWorkload() {
+        static std::string name = "uniform";
+        return name;
+    }
+
     struct Key {
         std::string testName;
         std::size_t binSize;
         std::size_t dataSize;
         std::size_t threadCount;
+        std::string workload = currentWorkload();
 
         bool operator<(const Key& other) const {
-            return std::tie(dataSize, binSize, testName, threadCount) <
-                   std::tie(other.dataSize, other.binSize, other.testName, other.threadCount);
+            return std::tie(dataSize, binSize, workload, testName, threadCount) <
+                   std::tie(other.dataSize, other.binSize, other.workload, other.testName, other.threadCount);
         }
     };
 
@@ -29,6 +40,24 @@ namespace timing {
         return map;
     }
 
+    // every timed iteration in order, the totals above are kept for the existing tables.
+    inline std::map<Key, std::vector<double>>& samples() {
+        static std::map<Key, std::vector<double>> map;
+        return map;
+    }
+
+    // input bytes per element for throughput, tests that never set it are assumed to read int.
+    inline std::map<Key, std::size_t>& elementBytes() {
+        static std::map<Key, std::size_t> map;
+        return map;
+    }
+
+    // perf counter totals over every timed iteration, only filled while perf::enabled().
+    inline std::map<Key, perf::Counts>& counters() {
+        static std::map<Key, perf::Counts> map;
+        return map;
+    }
+
     inline std::map<Key, time_point>& starts() {
         static std::map<Key, time_point> map;
         return map;
@@ -38,23 +67,37 @@ namespace timing {
         static std::mutex m;
         return m;
     }
+
+    // adds a duration measured elsewhere, e.g. a phase inside a solver.
+    inline void record(const Key& key, const double ms) {
+        std::lock_guard<std::mutex> lock(mutex());
+        totals()[key] += ms;
+        samples()[key].push_back(ms);
+    }
 }
 
 #define TIMING_BEGIN(NAME, BIN, SIZE, THREADS)               \
 do {                                                \
 std::lock_guard<std::mutex> lock(timing::mutex()); \
 timing::Key key{ NAME, BIN, SIZE, THREADS };             \
+if (trace::enabled()) trace::beginRun(key.testName + " [" + std::to_string(key.threadCount) + " threads, " + std::to_string(key.binSize) + " bins]"); \
+if (perf::enabled()) perf::begin();             \
 timing::starts()[key] = timing::clock::now();   \
 } while (0)
 
 #define TIMING_END(NAME, BIN, SIZE, THREADS)                 \
 do {                                                \
 auto end = timing::clock::now();                \
+const bool counted = perf::enabled();           \
+const perf::Counts counts = counted ? perf::end() : perf::Counts{}; \
+trace::endRun();                                \
 std::lock_guard<std::mutex> lock(timing::mutex()); \
 timing::Key key{ NAME, BIN, SIZE, THREADS };             \
 auto start = timing::starts().at(key);          \
 double ms = std::chrono::duration<double, std::milli>(end - start).count(); \
 timing::totals()[key] += ms;                    \
+timing::samples()[key].push_back(ms);           \
+if (counted) timing::counters()[key] += counts; \
 } while (0)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,243 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "WeightedHistogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+#include <new>
+#include <vector>
+
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+
+namespace {
+    template<typename W>
+    size_t accumulateScalar(const int* data, const W* weights, const size_t count, WeightAccumulator<W>* hist, const size_t laneCount) {
+        using A = WeightAccumulator<W>;
+        if (laneCount == WEIGHTED_LANES) {
+            for (size_t i = 0; i < count; ++i) {
+                hist[static_cast<size_t>(data[i]) * WEIGHTED_LANES + (i & (WEIGHTED_LANES - 1))] += static_cast<A>(weights[i]);
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                hist[data[i]] += static_cast<A>(weights[i]);
+            }
+        }
+        return 0;
+    }
+
+    // 8 weights widened to the accumulator type, one __m512 worth of int64 or double.
+    HISTOGRAM_TARGET_AVX512
+    __m512i widen(const int* weights) {
+        return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights)));
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    __m512d widen(const float* weights) {
+        return _mm512_cvtps_pd(_mm256_loadu_ps(weights));
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    void gatherAddScatter(int64_t* hist, const __m256i idx, const __m512i w) {
+        const __m512i sums = _mm512_add_epi64(_mm512_i32gather_epi64(idx, hist, sizeof(int64_t)), w);
+        _mm512_i32scatter_epi64(hist, idx, sums, sizeof(int64_t));
+    }
+
+    HISTOGRAM_TARGET_AVX512
+    void gatherAddScatter(double* hist, const __m256i idx, const __m512d w) {
+        const __m512d sums = _mm512_add_pd(_mm512_i32gather_pd(idx, hist, sizeof(double)), w);
+        _mm512_i32scatter_pd(hist, idx, sums, sizeof(double));
+    }
+
+    template<typename W>
+    HISTOGRAM_TARGET_AVX512
+    size_t accumulateAvx512(const int* data, const W* weights, const size_t count, WeightAccumulator<W>* hist, const size_t laneCount) {
+        using A = WeightAccumulator<W>;
+        size_t i = 0;
+        size_t vectorBlocks = 0;
+        if (laneCount == WEIGHTED_LANES) {
+            static_assert(WEIGHTED_LANES == 8);
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            for (; i + WEIGHTED_LANES <= count; i += WEIGHTED_LANES) {
+                const __m256i bins = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                gatherAddScatter(hist, _mm256_add_epi32(_mm256_slli_epi32(bins, 3), lanes), widen(weights + i));
+                ++vectorBlocks;
+            }
+            for (; i < count; ++i) {
+                hist[static_cast<size_t>(data[i]) * WEIGHTED_LANES + (i & (WEIGHTED_LANES - 1))] += static_cast<A>(weights[i]);
+            }
+        } else {
+            for (; i + 8 <= count; i += 8) {
+                const __m256i bins = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                // the zeroed upper half conflicts with itself, only the low 8 lanes are tested.
+                const __m512i conflicts = _mm512_conflict_epi32(_mm512_zextsi256_si512(bins));
+                if (_mm512_mask_test_epi32_mask(0xff, conflicts, conflicts) == 0) [[likely]] {
+                    gatherAddScatter(hist, bins, widen(weights + i));
+                    ++vectorBlocks;
+                } else {
+                    for (size_t j = i; j < i + 8; ++j) {
+                        hist[data[j]] += static_cast<A>(weights[j]);
+                    }
+                }
+            }
+            for (; i < count; ++i) {
+                hist[data[i]] += static_cast<A>(weights[i]);
+            }
+        }
+        return vectorBlocks;
+    }
+
+    template<typename A>
+    void validateWeighted(const A* truth, const A* test, const size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            bool match = truth[i] == test[i];
+            if constexpr (std::is_floating_point_v<A>) {
+                match = std::abs(truth[i] - test[i]) <= 1e-9 * std::max(std::abs(truth[i]), A(1));
+            }
+            if (!match) {
+                std::cout << "Error at index " << i << " -> Truth: " << truth[i] << " vs " << test[i] << std::endl;
+                abort();
+            }
+        }
+    }
+}
+
+size_t weightedLaneCount(const size_t maxVal, const size_t accumulatorBytes, const size_t l2Bytes) {
+    return maxVal * WEIGHTED_LANES * accumulatorBytes <= l2Bytes ? WEIGHTED_LANES : 1;
+}
+
+template<typename W>
+size_t accumulateWeighted(const SimdLevel level, const int* data, const W* weights, const size_t count, WeightAccumulator<W>* hist, const size_t laneCount) {
+    // AVX2 has gathers but no scatter, the stores would be scalar anyway.
+    if (level == SimdLevel::AVX512) {
+        return accumulateAvx512(data, weights, count, hist, laneCount);
+    }
+    return accumulateScalar(data, weights, count, hist, laneCount);
+}
+
+template<typename W>
+void solveThreadedWeightedHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<W[]>& weights,
+    const std::shared_ptr<WeightAccumulator<W>[]>& histogram, const std::shared_ptr<WeightAccumulator<W>[]>& laneHistograms,
+    const size_t dataSize, const size_t maxVal, const size_t threadAmount, const size_t laneCount, const size_t perThreadAccumulators,
+    const SimdLevel level, ThreadPool& pool) {
+    using A = WeightAccumulator<W>;
+    const size_t elementsPerThread = (dataSize + threadAmount - 1) / threadAmount;
+
+    pool.parallel_for(0, threadAmount, 1, [=, &data, &weights, &laneHistograms](const size_t t) {
+        trace::Scope scope(trace::Phase::Count);
+        const size_t start = std::min(t * elementsPerThread, dataSize);
+        const size_t end   = std::min(start + elementsPerThread, dataSize);
+        accumulateWeighted(level, data.get() + start, weights.get() + start, end - start,
+                           laneHistograms.get() + t * perThreadAccumulators, laneCount);
+    }).wait();
+
+    // bin sliced like reduceBinSliced<true>, with the lanes folded in the same pass. The order of the adds
+    // is fixed per bin, whichever task happens to own it.
+    constexpr size_t binsPerCacheLine = std::hardware_destructive_interference_size / sizeof(A);
+    const size_t binsPerThread = ((maxVal + threadAmount - 1) / threadAmount + binsPerCacheLine - 1) / binsPerCacheLine * binsPerCacheLine;
+    pool.parallel_for(0, threadAmount, 1, [=, &histogram, &laneHistograms](const size_t t) {
+        trace::Scope scope(trace::Phase::Reduce);
+        const size_t begin = std::min(t * binsPerThread, maxVal);
+        const size_t end   = std::min(begin + binsPerThread, maxVal);
+        for (size_t b = begin; b < end; ++b) {
+            A sum = 0;
+            for (size_t s = 0; s < threadAmount; ++s) {
+                A* lanes = laneHistograms.get() + s * perThreadAccumulators + b * laneCount;
+                for (size_t l = 0; l < laneCount; ++l) {
+                    sum += lanes[l];
+                    lanes[l] = 0;
+                }
+            }
+            histogram[b] = sum;
+        }
+    }).wait();
+}
+
+template<typename W>
+void profile_naive_weighted_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<W[]> &weights,
+                                          const std::shared_ptr<WeightAccumulator<W>[]> &truthHistogram, const std::shared_ptr<WeightAccumulator<W>[]> &testHistogram,
+                                          const size_t dataSize, const int maxVal, const std::string &testName, const size_t iterations) {
+    // warmup
+    solveWeightedNaiveHistogram(data, weights, testHistogram, dataSize);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        std::fill_n(testHistogram.get(), maxVal, 0); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, 1);
+        solveWeightedNaiveHistogram(data, weights, testHistogram, dataSize);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, 1);
+        validateWeighted(truthHistogram.get(), testHistogram.get(), maxVal);
+    }
+    std::lock_guard<std::mutex> lock(timing::mutex());
+    timing::elementBytes()[{testName, static_cast<size_t>(maxVal), dataSize, 1}] = sizeof(int) + sizeof(W);
+}
+
+template<typename W>
+void profile_threaded_weighted_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<W[]> &weights,
+                                             const std::shared_ptr<WeightAccumulator<W>[]> &truthHistogram, const std::shared_ptr<WeightAccumulator<W>[]> &testHistogram,
+                                             const size_t dataSize, const int maxVal, const size_t threadAmount, const std::string &testName, const size_t iterations,
+                                             ThreadPool& pool, const SimdLevel level) {
+    using A = WeightAccumulator<W>;
+    const size_t pageSize = systemPageSize();
+    const size_t laneCount = weightedLaneCount(maxVal, sizeof(A));
+    const size_t perThreadAccumulators = (maxVal * laneCount * sizeof(A) + pageSize - 1) / pageSize * pageSize / sizeof(A);
+    const size_t laneSize = perThreadAccumulators * threadAmount;
+
+    const std::shared_ptr<A[]> laneHistograms = makeAlignedArray<A>(laneSize, pageSize);
+    std::fill_n(laneHistograms.get(), laneSize, 0);
+
+    if (level == SimdLevel::AVX512 && laneCount == 1) {
+        // 8 distinct bins have to take the gather/scatter path, one repeated bin has to fall back to scalar.
+        const int distinct[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+        const int repeated[8] = {0, 1, 2, 3, 4, 5, 6, 0};
+        const W ones[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+        A probe[8] = {};
+        const size_t distinctBlocks = accumulateWeighted(level, distinct, ones, 8, probe, 1);
+        const size_t repeatedBlocks = accumulateWeighted(level, repeated, ones, 8, probe, 1);
+        if (distinctBlocks != 1 || repeatedBlocks != 0 || probe[0] != A(3) || probe[7] != A(1)) {
+            std::cout << "Error: " << testName << " conflict detection picked the wrong path" << std::endl;
+            abort();
+        }
+    }
+
+    // warmup, also the reference every timed run has to reproduce exactly.
+    std::fill_n(testHistogram.get(), maxVal, 0);
+    solveThreadedWeightedHistogram(data, weights, testHistogram, laneHistograms, dataSize, maxVal, threadAmount, laneCount, perThreadAccumulators, level, pool);
+    validateWeighted(truthHistogram.get(), testHistogram.get(), maxVal);
+    const std::vector<A> firstRun(testHistogram.get(), testHistogram.get() + maxVal);
+
+    for (size_t i = 0; i < iterations; ++i) {
+        std::fill_n(testHistogram.get(), maxVal, 0); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        solveThreadedWeightedHistogram(data, weights, testHistogram, laneHistograms, dataSize, maxVal, threadAmount, laneCount, perThreadAccumulators, level, pool);
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validateWeighted(truthHistogram.get(), testHistogram.get(), maxVal);
+        if (std::memcmp(firstRun.data(), testHistogram.get(), maxVal * sizeof(A)) != 0) {
+            std::cout << "Error: " << testName << " is not reproducible between runs" << std::endl;
+            abort();
+        }
+    }
+    std::lock_guard<std::mutex> lock(timing::mutex());
+    timing::elementBytes()[{testName, static_cast<size_t>(maxVal), dataSize, threadAmount}] = sizeof(int) + sizeof(W);
+}
+
+template size_t accumulateWeighted<int>(SimdLevel, const int*, const int*, size_t, int64_t*, size_t);
+template size_t accumulateWeighted<float>(SimdLevel, const int*, const float*, size_t, double*, size_t);
+
+template void solveThreadedWeightedHistogram<int>(const std::shared_ptr<int[]>&, const std::shared_ptr<int[]>&, const std::shared_ptr<int64_t[]>&,
+    const std::shared_ptr<int64_t[]>&, size_t, size_t, size_t, size_t, size_t, SimdLevel, ThreadPool&);
+template void solveThreadedWeightedHistogram<float>(const std::shared_ptr<int[]>&, const std::shared_ptr<float[]>&, const std::shared_ptr<double[]>&,
+    const std::shared_ptr<double[]>&, size_t, size_t, size_t, size_t, size_t, SimdLevel, ThreadPool&);
+
+template void profile_naive_weighted_cpu_histogram<int>(const std::shared_ptr<int[]>&, const std::shared_ptr<int[]>&, const std::shared_ptr<int64_t[]>&,
+    const std::shared_ptr<int64_t[]>&, size_t, int, const std::string&, size_t);
+template void profile_naive_weighted_cpu_histogram<float>(const std::shared_ptr<int[]>&, const std::shared_ptr<float[]>&, const std::shared_ptr<double[]>&,
+    const std::shared_ptr<double[]>&, size_t, int, const std::string&, size_t);
+
+template void profile_threaded_weighted_cpu_histogram<int>(const std::shared_ptr<int[]>&, const std::shared_ptr<int[]>&, const std::shared_ptr<int64_t[]>&,
+    const std::shared_ptr<int64_t[]>&, size_t, int, size_t, const std::string&, size_t, ThreadPool&, SimdLevel);
+template void profile_threaded_weighted_cpu_histogram<float>(const std::shared_ptr<int[]>&, const std::shared_ptr<float[]>&, const std::shared_ptr<double[]>&,
+    const std::shared_ptr<double[]>&, size_t, int, size_t, const std::string&, size_t, ThreadPool&, SimdLevel);
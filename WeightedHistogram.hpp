@@ -0,0 +1,69 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_WEIGHTEDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_WEIGHTEDHISTOGRAM_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "Common.hpp"
+#include "CpuFeatures.hpp"
+#include "MachineInfo.hpp"
+#include "ThreadPool.hpp"
+
+// Weighted histograms sum weights[i] into bin data[i] instead of counting. Integer weights accumulate in
+// int64, floating point weights in double. Implemented for int and float weights.
+//
+// Every thread keeps laneCount interleaved copies of its sub-histogram, hist[bin * laneCount + lane], and
+// element i of its range always goes to lane i % laneCount. With 8 lanes one AVX-512 vector of 8 weights
+// never has two lanes on the same accumulator; with 1 lane (histograms too big for 8 copies in L2)
+// VPCONFLICTD finds the vectors that repeat a bin and those fall back to scalar adds.
+//
+// Floating point sums are reproducible: the partition only depends on threadAmount, each lane adds its
+// elements in input order whatever the SIMD level, and the reduction adds lanes then threads in index order.
+constexpr size_t WEIGHTED_LANES = 8;
+
+template<typename W>
+using WeightAccumulator = std::conditional_t<std::is_floating_point_v<W>, double, int64_t>;
+
+// the separate scalar loop, also the truth for the threaded solvers.
+template<typename T, typename W, typename U>
+void solveWeightedNaiveHistogram(const T& data, const W& weights, const U& histogram, const size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        histogram[data[i]] += weights[i];
+    }
+}
+
+// WEIGHTED_LANES while the lane copies of one private histogram fit in L2, otherwise 1.
+size_t weightedLaneCount(size_t maxVal, size_t accumulatorBytes, size_t l2Bytes = machineInfo().l2Bytes);
+
+// adds weights[0, count) into the lane copies of hist, which must hold maxVal * laneCount accumulators.
+// Returns how many blocks of 8 elements went through one gather/add/scatter.
+template<typename W>
+size_t accumulateWeighted(SimdLevel level, const int* data, const W* weights, size_t count, WeightAccumulator<W>* hist, size_t laneCount);
+
+// laneHistograms holds threadAmount sub-histograms of perThreadAccumulators each and must be zero on entry,
+// the reduction zeroes it again.
+template<typename W>
+void solveThreadedWeightedHistogram(const std::shared_ptr<int[]>& data, const std::shared_ptr<W[]>& weights,
+    const std::shared_ptr<WeightAccumulator<W>[]>& histogram, const std::shared_ptr<WeightAccumulator<W>[]>& laneHistograms,
+    size_t dataSize, size_t maxVal, size_t threadAmount, size_t laneCount, size_t perThreadAccumulators, SimdLevel level, ThreadPool& pool);
+
+template<typename W>
+void profile_naive_weighted_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<W[]> &weights,
+                                          const std::shared_ptr<WeightAccumulator<W>[]> &truthHistogram, const std::shared_ptr<WeightAccumulator<W>[]> &testHistogram,
+                                          size_t dataSize, int maxVal, const std::string &testName, size_t iterations);
+
+// floating point results are checked against the truth with a relative tolerance and against the first
+// run bit for bit.
+template<typename W>
+void profile_threaded_weighted_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<W[]> &weights,
+                                             const std::shared_ptr<WeightAccumulator<W>[]> &truthHistogram, const std::shared_ptr<WeightAccumulator<W>[]> &testHistogram,
+                                             size_t dataSize, int maxVal, size_t threadAmount, const std::string &testName, size_t iterations, ThreadPool& pool,
+                                             SimdLevel level = detectSimdLevel());
+
+#endif //CUDAHISTOGRAMS_WEIGHTEDHISTOGRAM_HPP
@@ -0,0 +1,278 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "WindowedHistogram.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "PhaseTrace.hpp"
+#include "Timer.hpp"
+#include "ThreadedReducedHistogram.hpp"
+
+namespace {
+    void validateDecayed(const double* truth, const double* test, const size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            if (std::abs(truth[i] - test[i]) > 1e-9 * std::max(std::abs(truth[i]), 1.0)) {
+                std::cout << "Error at index " << i << " -> Truth: " << truth[i] << " vs " << test[i] << std::endl;
+                abort();
+            }
+        }
+    }
+}
+
+BucketedHistogram::BucketedHistogram(const size_t maxVal, const size_t bucketElements, const size_t threadAmount, ThreadPool& pool)
+    : maxVal(maxVal), threadAmount(threadAmount), bucketElements(bucketElements),
+      perThreadInts(reducedPerThreadBytesPaged(maxVal, systemPageSize()) / sizeof(int)), pool(pool) {
+    if (maxVal == 0 || threadAmount == 0) throw std::invalid_argument("bucketed histograms need bins and at least one slot");
+    privateHistograms = makeAlignedArray<int>(perThreadInts * threadAmount, systemPageSize());
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+}
+
+std::pair<size_t, size_t> BucketedHistogram::binSlice(const size_t t) const {
+    constexpr size_t binsPerCacheLine = std::hardware_destructive_interference_size / sizeof(int);
+    const size_t binsPerThread = ((maxVal + threadAmount - 1) / threadAmount + binsPerCacheLine - 1) & ~(binsPerCacheLine - 1);
+    const size_t begin = std::min(t * binsPerThread, maxVal);
+    return {begin, std::min(begin + binsPerThread, maxVal)};
+}
+
+void BucketedHistogram::ingest(const size_t slot, const std::span<const int> values) {
+    trace::Scope scope(trace::Phase::Count);
+    int* hist = privateHistograms.get() + slot * perThreadInts;
+    for (const int value : values) {
+        ++hist[value];
+    }
+}
+
+void BucketedHistogram::ingestParallel(std::span<const int> values) {
+    while (!values.empty()) {
+        const size_t take = bucketElements == 0 ? values.size() : std::min(values.size(), bucketElements - pending);
+        const std::span<const int> piece = values.first(take);
+        const size_t elementsPerThread = (take + threadAmount - 1) / threadAmount;
+
+        pool.parallel_for(0, threadAmount, 1, [this, piece, elementsPerThread](const size_t t) {
+            const size_t start = std::min(t * elementsPerThread, piece.size());
+            const size_t end   = std::min(start + elementsPerThread, piece.size());
+            ingest(t, piece.subspan(start, end - start));
+        }).wait();
+
+        values = values.subspan(take);
+        pending += take;
+        if (bucketElements != 0 && pending == bucketElements) {
+            rotate();
+        }
+    }
+}
+
+void BucketedHistogram::rotate(const size_t count) {
+    if (count == 0) return;
+    seal(count);
+    pending = 0;
+}
+
+void BucketedHistogram::advanceTo(const std::chrono::steady_clock::time_point now, const std::chrono::nanoseconds bucketDuration) {
+    if (!bucketStart) {
+        bucketStart = now;
+        return;
+    }
+    const auto elapsed = static_cast<size_t>((now - *bucketStart) / bucketDuration);
+    if (elapsed > 0) {
+        rotate(elapsed);
+        *bucketStart += elapsed * bucketDuration;
+    }
+}
+
+void BucketedHistogram::reset() {
+    clear(privateHistograms.get(), perThreadInts * threadAmount);
+    pending = 0;
+    bucketStart.reset();
+    resetResult();
+}
+
+WindowedHistogram::WindowedHistogram(const size_t maxVal, const size_t buckets, const size_t bucketElements, const size_t threadAmount, ThreadPool& pool)
+    : BucketedHistogram(maxVal, bucketElements, threadAmount, pool), buckets(buckets), ringElements(buckets) {
+    if (buckets == 0) throw std::invalid_argument("WindowedHistogram needs at least one bucket");
+    ring = makeAlignedArray<int>(buckets * maxVal, systemPageSize());
+    window = makeAlignedArray<int>(maxVal, systemPageSize());
+    resetResult();
+}
+
+void WindowedHistogram::seal(const size_t count) {
+    if (count > buckets) {
+        // the new bucket is pushed out by the empty ones after it, the slots only need emptying.
+        pool.parallel_for(0, threadAmount, 1, [&](const size_t t) {
+            trace::Scope scope(trace::Phase::Reduce);
+            const auto [begin, end] = binSlice(t);
+            for (size_t b = begin; b < end; ++b) {
+                takeBin(b);
+            }
+        }).wait();
+        resetResult();
+        return;
+    }
+
+    std::atomic<size_t> sealedElements = 0;
+
+    pool.parallel_for(0, threadAmount, 1, [&](const size_t t) {
+        trace::Scope scope(trace::Phase::Reduce);
+        const auto [begin, end] = binSlice(t);
+        size_t elements = 0;
+        for (size_t r = 0; r < count; ++r) {
+            int* oldest = ring.get() + ((head + r) % buckets) * maxVal;
+            for (size_t b = begin; b < end; ++b) {
+                const int sum = r == 0 ? takeBin(b) : 0;
+                window[b] += sum - oldest[b];
+                oldest[b] = sum;
+                elements += static_cast<size_t>(sum);
+            }
+        }
+        sealedElements.fetch_add(elements, std::memory_order_relaxed);
+    }).wait();
+
+    for (size_t r = 0; r < count; ++r) {
+        const size_t added = r == 0 ? sealedElements.load() : 0;
+        elementsInWindow = elementsInWindow + added - ringElements[head];
+        ringElements[head] = added;
+        head = (head + 1) % buckets;
+    }
+}
+
+void WindowedHistogram::resetResult() {
+    clear(ring.get(), buckets * maxVal);
+    clear(window.get(), maxVal);
+    std::fill(ringElements.begin(), ringElements.end(), 0);
+    head = 0;
+    elementsInWindow = 0;
+}
+
+void WindowedHistogram::snapshot(int* histogram) const {
+    std::memcpy(histogram, window.get(), maxVal * sizeof(int));
+}
+
+DecayedHistogram::DecayedHistogram(const size_t maxVal, const double halfLifeBuckets, const size_t bucketElements, const size_t threadAmount, ThreadPool& pool)
+    : BucketedHistogram(maxVal, bucketElements, threadAmount, pool), alpha(std::exp2(-1.0 / halfLifeBuckets)) {
+    if (!(halfLifeBuckets > 0.0)) throw std::invalid_argument("DecayedHistogram needs a positive half life");
+    decayed = makeAlignedArray<double>(maxVal, systemPageSize());
+    resetResult();
+}
+
+void DecayedHistogram::seal(const size_t count) {
+    // the empty buckets after the first only decay, which folds into one factor.
+    const double tail = std::pow(alpha, static_cast<double>(count - 1));
+
+    pool.parallel_for(0, threadAmount, 1, [&](const size_t t) {
+        trace::Scope scope(trace::Phase::Reduce);
+        const auto [begin, end] = binSlice(t);
+        for (size_t b = begin; b < end; ++b) {
+            const double value = decayed[b] * alpha + takeBin(b);
+            decayed[b] = count == 1 ? value : value * tail;
+        }
+    }).wait();
+}
+
+void DecayedHistogram::resetResult() {
+    std::fill_n(decayed.get(), maxVal, 0.0);
+}
+
+void DecayedHistogram::snapshot(double* histogram) const {
+    std::memcpy(histogram, decayed.get(), maxVal * sizeof(double));
+}
+
+void profile_windowed_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                    const size_t dataSize, const int maxVal, const size_t buckets, const size_t bucketElements, const size_t threadAmount,
+                                    const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    WindowedHistogram histogram(static_cast<size_t>(maxVal), buckets, bucketElements, threadAmount, pool);
+    const size_t ticks = dataSize / bucketElements;
+
+    const auto run = [&]() {
+        histogram.reset();
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            histogram.ingestParallel({data.get() + tick * bucketElements, bucketElements});
+            histogram.snapshot(testHistogram.get());
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        run();
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+
+    // a gap longer than the window drops everything, including a bucket that was still open.
+    histogram.ingestParallel({data.get(), std::min(dataSize, bucketElements - 1)});
+    histogram.rotate(buckets + 1);
+    histogram.snapshot(testHistogram.get());
+    const std::vector<int> empty(maxVal, 0);
+    validate(empty, testHistogram, maxVal);
+    if (histogram.windowElements() != 0) {
+        std::cout << "Error: " << histogram.windowElements() << " elements left in an expired window" << std::endl;
+        abort();
+    }
+}
+
+void profile_windowed_rebuild_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                            const size_t dataSize, const int maxVal, const size_t buckets, const size_t bucketElements, const size_t threadAmount,
+                                            const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    const size_t pageSize = systemPageSize();
+    const size_t perThreadBytesPaged = reducedPerThreadBytesPaged(maxVal, pageSize);
+    const size_t reducedSize = perThreadBytesPaged * threadAmount;
+    const std::shared_ptr<int[]> reducedHistogram = makeAlignedArray<int>(reducedSize / sizeof(int), pageSize);
+    const size_t ticks = dataSize / bucketElements;
+
+    const auto run = [&]() {
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            const size_t end = (tick + 1) * bucketElements;
+            const size_t begin = end - std::min(end, buckets * bucketElements);
+            // aliasing pointer, the solver reads its input from index 0.
+            const std::shared_ptr<int[]> window(data, data.get() + begin);
+            memset(reducedHistogram.get(), 0, reducedSize);
+            solveThreadedReducedHistogram<false, false, false, false, ReductionStrategy::BinSliced>(window, testHistogram, reducedHistogram,
+                end - begin, maxVal, threadAmount, pageSize, reducedSize, perThreadBytesPaged, pool);
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        clear(testHistogram.get(), maxVal); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        run();
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validate(truthHistogram, testHistogram, maxVal);
+    }
+}
+
+void profile_decayed_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<double[]> &truthHistogram, const std::shared_ptr<double[]> &testHistogram,
+                                   const size_t dataSize, const int maxVal, const double halfLifeBuckets, const size_t bucketElements, const size_t threadAmount,
+                                   const std::string &testName, const size_t iterations, ThreadPool& pool) {
+    DecayedHistogram histogram(static_cast<size_t>(maxVal), halfLifeBuckets, bucketElements, threadAmount, pool);
+    const size_t ticks = dataSize / bucketElements;
+
+    const auto run = [&]() {
+        histogram.reset();
+        for (size_t tick = 0; tick < ticks; ++tick) {
+            histogram.ingestParallel({data.get() + tick * bucketElements, bucketElements});
+            histogram.snapshot(testHistogram.get());
+        }
+    };
+
+    // warmup
+    run();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        std::fill_n(testHistogram.get(), maxVal, 0.0); // clear last test if any.
+        TIMING_BEGIN(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        run();
+        TIMING_END(testName, static_cast<size_t>(maxVal), dataSize, threadAmount);
+        validateDecayed(truthHistogram.get(), testHistogram.get(), maxVal);
+    }
+}
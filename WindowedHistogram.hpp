@@ -0,0 +1,152 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_WINDOWEDHISTOGRAM_HPP
+#define CUDAHISTOGRAMS_WINDOWEDHISTOGRAM_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common.hpp"
+#include "ThreadPool.hpp"
+
+// Streaming histograms over buckets of the input. Values are counted into per-slot private histograms
+// (the reduced solver's page padded layout) until the current bucket is sealed; sealing reduces the slots
+// bin sliced, clearing them as it reads, and folds the bucket into the result in the same pass. A rotation
+// therefore costs O(bins * slots), independent of how many elements the window covers.
+//
+// With bucketElements > 0, ingestParallel seals a bucket every bucketElements values. Otherwise buckets
+// are sealed by rotate() or advanceTo(), e.g. once per window duration / buckets for a time window.
+class BucketedHistogram {
+protected:
+    const size_t maxVal;
+    const size_t threadAmount;
+    const size_t bucketElements;
+    const size_t perThreadInts;
+    ThreadPool& pool;
+
+    std::shared_ptr<int[]> privateHistograms;
+    size_t pending = 0; // values ingestParallel put in the open bucket
+    std::optional<std::chrono::steady_clock::time_point> bucketStart;
+
+    // folds the open bucket into the result, then count - 1 empty buckets.
+    virtual void seal(size_t count) = 0;
+    virtual void resetResult() = 0;
+
+    // slice [begin, end) of the bins for task t of threadAmount, cache line aligned.
+    std::pair<size_t, size_t> binSlice(size_t t) const;
+    // sums bin b over every slot and zeroes it, the per-bin step of seal().
+    int takeBin(const size_t b) {
+        int sum = 0;
+        for (size_t s = 0; s < threadAmount; ++s) {
+            sum += privateHistograms[s * perThreadInts + b];
+            privateHistograms[s * perThreadInts + b] = 0;
+        }
+        return sum;
+    }
+
+public:
+    BucketedHistogram(size_t maxVal, size_t bucketElements, size_t threadAmount, ThreadPool& pool);
+    virtual ~BucketedHistogram() = default;
+
+    BucketedHistogram(const BucketedHistogram&) = delete;
+    BucketedHistogram& operator=(const BucketedHistogram&) = delete;
+
+    size_t bins() const { return maxVal; }
+    size_t slots() const { return threadAmount; }
+
+    // counts values into private histogram slot. Calls with distinct slots may run concurrently, but not
+    // alongside ingestParallel, rotate, advanceTo or a snapshot.
+    void ingest(size_t slot, std::span<const int> values);
+
+    // single producer: spreads values over every slot on the pool, sealing buckets at bucketElements.
+    void ingestParallel(std::span<const int> values);
+
+    // seals the open bucket, count > 1 also seals count - 1 empty ones after it (time passed without data).
+    void rotate(size_t count = 1);
+
+    // rotates once per bucketDuration elapsed since the open bucket started, the first call only starts it.
+    void advanceTo(std::chrono::steady_clock::time_point now, std::chrono::nanoseconds bucketDuration);
+
+    void reset();
+};
+
+// Histogram of the last buckets sealed buckets. Keeps them in a ring; sealing adds the new bucket to the
+// window and subtracts the one it overwrites.
+class WindowedHistogram final : public BucketedHistogram {
+    const size_t buckets;
+    std::shared_ptr<int[]> ring;      // ring[bucket * maxVal + bin]
+    std::shared_ptr<int[]> window;
+    std::vector<size_t> ringElements;
+    size_t head = 0;
+    size_t elementsInWindow = 0;
+
+    void seal(size_t count) override;
+    void resetResult() override;
+
+public:
+    WindowedHistogram(size_t maxVal, size_t buckets, size_t bucketElements, size_t threadAmount, ThreadPool& pool);
+    ~WindowedHistogram() override = default;
+
+    size_t windowBuckets() const { return buckets; }
+    size_t windowElements() const { return elementsInWindow; }
+    const int* counts() const { return window.get(); }
+    void snapshot(int* histogram) const;
+};
+
+// Exponentially decayed histogram: every seal multiplies the history by alpha = 2^(-1 / halfLifeBuckets)
+// and adds the new bucket, so a bucket weighs half as much halfLifeBuckets seals later.
+class DecayedHistogram final : public BucketedHistogram {
+    const double alpha;
+    std::shared_ptr<double[]> decayed;
+
+    void seal(size_t count) override;
+    void resetResult() override;
+
+public:
+    DecayedHistogram(size_t maxVal, double halfLifeBuckets, size_t bucketElements, size_t threadAmount, ThreadPool& pool);
+    ~DecayedHistogram() override = default;
+
+    double decay() const { return alpha; }
+    const double* counts() const { return decayed.get(); }
+    void snapshot(double* histogram) const;
+};
+
+// the decayed truth: bucket after bucket of data, history * alpha + bucket counts. Only whole buckets.
+template<typename T, typename U>
+void solveDecayedNaiveHistogram(const T& data, const U& histogram, const size_t dataSize, const size_t maxVal, const size_t bucketElements, const double alpha) {
+    std::vector<int> bucket(maxVal);
+    for (size_t begin = 0; begin + bucketElements <= dataSize; begin += bucketElements) {
+        std::fill(bucket.begin(), bucket.end(), 0);
+        for (size_t i = begin; i < begin + bucketElements; ++i) {
+            ++bucket[data[i]];
+        }
+        for (size_t b = 0; b < maxVal; ++b) {
+            histogram[b] = histogram[b] * alpha + bucket[b];
+        }
+    }
+}
+
+// Streams data through a WindowedHistogram in ticks of bucketElements and snapshots the window every tick.
+// truthHistogram is the histogram of the last buckets whole buckets of data.
+void profile_windowed_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                    size_t dataSize, int maxVal, size_t buckets, size_t bucketElements, size_t threadAmount, const std::string &testName,
+                                    size_t iterations, ThreadPool& pool);
+
+// the same ticks, but every tick rebuilds the window from scratch with the bin sliced reduced solver.
+void profile_windowed_rebuild_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<int[]> &truthHistogram, const std::shared_ptr<int[]> &testHistogram,
+                                            size_t dataSize, int maxVal, size_t buckets, size_t bucketElements, size_t threadAmount, const std::string &testName,
+                                            size_t iterations, ThreadPool& pool);
+
+void profile_decayed_cpu_histogram(const std::shared_ptr<int[]> &data, const std::shared_ptr<double[]> &truthHistogram, const std::shared_ptr<double[]> &testHistogram,
+                                   size_t dataSize, int maxVal, double halfLifeBuckets, size_t bucketElements, size_t threadAmount, const std::string &testName,
+                                   size_t iterations, ThreadPool& pool);
+
+#endif //CUDAHISTOGRAMS_WINDOWEDHISTOGRAM_HPP
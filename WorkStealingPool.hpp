@@ -0,0 +1,332 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_WORKSTEALINGPOOL_HPP
+#define CUDAHISTOGRAMS_WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace ws {
+
+    struct Job;
+
+    // a contiguous slice of one parallel_for. Items live in their job's preallocated array,
+    // the deques only ever move pointers around.
+    struct Item {
+        Job* job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct Job {
+        const size_t grain;
+        const size_t capacity;
+        std::unique_ptr<Item[]> items;
+        std::atomic<size_t> nextItem{0};
+        std::atomic<size_t> remaining;
+        std::atomic<bool> done{false};
+        std::atomic<bool> released{false};
+        std::atomic_flag failed = ATOMIC_FLAG_INIT;
+        std::exception_ptr error;
+
+        Job(const size_t begin, const size_t end, const size_t grain)
+            : grain(grain), capacity((end - begin + grain - 1) / grain + 1),
+              items(new Item[capacity]), remaining(end - begin) {
+            items[nextItem++] = {this, begin, end};
+        }
+        virtual ~Job() = default;
+        virtual void run(size_t begin, size_t end) = 0;
+
+        // every split consumes one slot, and a range can't be split into more pieces than it has grains.
+        Item* allocate(const size_t begin, const size_t end) {
+            const size_t idx = nextItem.fetch_add(1, std::memory_order_relaxed);
+            if (idx >= capacity) return nullptr;
+            items[idx] = {this, begin, end};
+            return &items[idx];
+        }
+
+        void finish(const size_t count) {
+            if (remaining.fetch_sub(count, std::memory_order_acq_rel) == count) {
+                done.store(true, std::memory_order_release);
+                done.notify_all();
+                // last touch of the job by a worker, the owner may free it from here on.
+                released.store(true, std::memory_order_release);
+            }
+        }
+
+        void waitReleased() const {
+            done.wait(false, std::memory_order_acquire);
+            while (!released.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    template<typename F>
+    struct JobImpl final : Job {
+        F fn;
+
+        JobImpl(const size_t begin, const size_t end, const size_t grain, F&& fn)
+            : Job(begin, end, grain), fn(std::move(fn)) {}
+
+        void run(const size_t begin, const size_t end) override {
+            invokeRange(fn, begin, end);
+        }
+    };
+
+    // Chase-Lev deque, the owner pushes/pops at the bottom, thieves take from the top.
+    class Deque {
+        static constexpr int64_t CAPACITY = 4096;
+        std::unique_ptr<std::atomic<Item*>[]> buffer{new std::atomic<Item*>[CAPACITY]};
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+
+    public:
+        bool push(Item* item) {
+            const int64_t b = bottom.load(std::memory_order_relaxed);
+            const int64_t t = top.load(std::memory_order_acquire);
+            if (b - t >= CAPACITY) return false;
+            buffer[b & (CAPACITY - 1)].store(item, std::memory_order_relaxed);
+            // publishes the item (and the slot it points to) to thieves reading bottom.
+            bottom.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        Item* pop() {
+            const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            Item* item = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (t == b) {
+                // last item, race the thieves for it.
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        Item* steal() {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b) return nullptr;
+
+            Item* item = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            return item;
+        }
+    };
+}
+
+// Work stealing replacement for ThreadPool. Work is submitted in bulk through parallel_for, which
+// allocates once per call; the range is split lazily by whoever picks it up, halves go onto that
+// worker's lock-free deque and idle workers steal them.
+class WorkStealingPool {
+    const size_t numThreads;
+    std::vector<std::thread> threads;
+    std::unique_ptr<ws::Deque[]> deques;
+
+    // entry point for submissions from outside the pool, only touched once per parallel_for.
+    std::mutex injectionMutex;
+    std::deque<ws::Item*> injected;
+    std::atomic<size_t> injectedCount{0};
+
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<size_t> sleepers{0};
+    std::atomic<bool> isShutdown{false};
+
+    static size_t& workerIndex() {
+        thread_local size_t idx = SIZE_MAX;
+        return idx;
+    }
+
+    static WorkStealingPool*& workerPool() {
+        thread_local WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    void wake() {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) != 0) {
+            epoch.notify_all();
+        }
+    }
+
+    ws::Item* takeInjected() {
+        if (injectedCount.load(std::memory_order_relaxed) == 0) return nullptr;
+        std::lock_guard lock(injectionMutex);
+        if (injected.empty()) return nullptr;
+        ws::Item* item = injected.front();
+        injected.pop_front();
+        injectedCount.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+    }
+
+    ws::Item* findWork(const size_t self) {
+        if (ws::Item* item = deques[self].pop()) return item;
+        for (size_t i = 1; i < numThreads; ++i) {
+            if (ws::Item* item = deques[(self + i) % numThreads].steal()) return item;
+        }
+        return takeInjected();
+    }
+
+    void execute(const size_t self, const ws::Item* item) {
+        ws::Job* job = item->job;
+        size_t begin = item->begin;
+        size_t end = item->end;
+
+        // keep the lower half, publish the upper half for thieves.
+        while (true) {
+            const size_t grains = (end - begin + job->grain - 1) / job->grain;
+            if (grains < 2) break;
+            const size_t mid = begin + grains / 2 * job->grain;
+            ws::Item* upper = job->allocate(mid, end);
+            if (!upper || !deques[self].push(upper)) break;
+            wake();
+            end = mid;
+        }
+
+        for (size_t chunk = begin; chunk < end; chunk += job->grain) {
+            if (job->failed.test(std::memory_order_relaxed)) break;
+            try {
+                job->run(chunk, std::min(chunk + job->grain, end));
+            } catch (...) {
+                if (!job->failed.test_and_set()) {
+                    job->error = std::current_exception();
+                }
+            }
+        }
+        job->finish(end - begin);
+    }
+
+    void work(const size_t threadIdx) {
+        workerIndex() = threadIdx;
+        workerPool() = this;
+
+        while (!isShutdown.load(std::memory_order_acquire)) {
+            const uint64_t seen = epoch.load(std::memory_order_seq_cst);
+            if (ws::Item* item = findWork(threadIdx)) {
+                execute(threadIdx, item);
+                continue;
+            }
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            epoch.wait(seen, std::memory_order_seq_cst);
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+public:
+    // single completion handle for a whole parallel_for, waits on destruction.
+    class BulkHandle {
+        friend class WorkStealingPool;
+        std::shared_ptr<ws::Job> job;
+        WorkStealingPool* pool = nullptr;
+
+        BulkHandle(std::shared_ptr<ws::Job> job, WorkStealingPool* pool) : job(std::move(job)), pool(pool) {}
+
+    public:
+        BulkHandle() = default;
+        BulkHandle(BulkHandle&&) noexcept = default;
+        BulkHandle& operator=(BulkHandle&& other) noexcept {
+            if (this != &other) {
+                if (job) job->waitReleased();
+                job = std::move(other.job);
+                pool = other.pool;
+            }
+            return *this;
+        }
+
+        bool ready() const {
+            return !job || job->done.load(std::memory_order_acquire);
+        }
+
+        void wait() {
+            if (!job) return;
+            // a worker waiting on a nested parallel_for helps out instead of blocking its slot.
+            if (workerPool() == pool) {
+                while (!job->done.load(std::memory_order_acquire)) {
+                    if (ws::Item* item = pool->findWork(workerIndex())) {
+                        pool->execute(workerIndex(), item);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            job->waitReleased();
+
+            const std::shared_ptr<ws::Job> finished = std::move(job);
+            if (finished->error) {
+                std::rethrow_exception(finished->error);
+            }
+        }
+
+        ~BulkHandle() {
+            if (job) job->waitReleased();
+        }
+    };
+
+    explicit WorkStealingPool(const size_t numThreads) : numThreads(numThreads), deques(new ws::Deque[numThreads]) {
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back(&WorkStealingPool::work, this, i);
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return numThreads; }
+
+    // index of the calling worker in [0, size()), SIZE_MAX outside the pool.
+    static size_t currentWorker() { return workerIndex(); }
+
+    // runs fn(i) or fn(chunkBegin, chunkEnd) over [begin, end) in chunks of at most grain elements.
+    template<typename F>
+    BulkHandle parallel_for(const size_t begin, const size_t end, const size_t grain, F&& fn) {
+        auto job = std::make_shared<ws::JobImpl<std::decay_t<F>>>(begin, end, std::max<size_t>(grain, 1), std::decay_t<F>(std::forward<F>(fn)));
+        if (begin >= end) {
+            job->done.store(true);
+            job->released.store(true);
+            return {std::move(job), this};
+        }
+
+        ws::Item* root = &job->items[0];
+        if (workerPool() != this || !deques[workerIndex()].push(root)) {
+            std::lock_guard lock(injectionMutex);
+            injected.push_back(root);
+            injectedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake();
+        return {std::move(job), this};
+    }
+
+    ~WorkStealingPool() {
+        isShutdown.store(true, std::memory_order_release);
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        epoch.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+};
+
+#endif //CUDAHISTOGRAMS_WORKSTEALINGPOOL_HPP
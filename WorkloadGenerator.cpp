@@ -0,0 +1,152 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#include "WorkloadGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    // one stream per independent decision, so e.g. run boundaries never correlate with run values.
+    enum Stream : uint64_t {
+        Values = 1,
+        RunBreaks = 2
+    };
+
+    std::vector<double> zipfWeights(const size_t bins, const double exponent) {
+        std::vector<double> weights(bins);
+        for (size_t b = 0; b < bins; ++b) {
+            weights[b] = 1.0 / std::pow(static_cast<double>(b + 1), exponent);
+        }
+        return weights;
+    }
+
+    std::vector<double> normalWeights(const size_t bins) {
+        const double mean = static_cast<double>(bins) / 2.0;
+        const double sigma = std::max(static_cast<double>(bins) / 8.0, 0.5);
+        std::vector<double> weights(bins);
+        for (size_t b = 0; b < bins; ++b) {
+            const double z = (static_cast<double>(b) + 0.5 - mean) / sigma;
+            weights[b] = std::exp(-0.5 * z * z);
+        }
+        return weights;
+    }
+
+    std::vector<double> skewedWeights(const size_t bins, const size_t hotBins) {
+        const size_t hot = std::min(hotBins, bins);
+        std::vector<double> weights(bins, 0.5 / static_cast<double>(bins));
+        for (size_t h = 0; h < hot; ++h) {
+            weights[h * (bins / hot)] += 0.5 / static_cast<double>(hot);
+        }
+        return weights;
+    }
+}
+
+const char* distributionName(const Distribution distribution) {
+    switch (distribution) {
+        case Distribution::Uniform:   return "uniform";
+        case Distribution::Zipf:      return "zipf";
+        case Distribution::Normal:    return "normal";
+        case Distribution::Sorted:    return "sorted";
+        case Distribution::Clustered: return "clustered";
+        case Distribution::SingleBin: return "single bin";
+        case Distribution::Skewed:    return "skewed";
+    }
+    return "unknown";
+}
+
+AliasTable::AliasTable(const std::vector<double>& weights) : threshold(weights.size()), alias(weights.size()) {
+    const size_t n = weights.size();
+    if (n == 0) throw std::invalid_argument("AliasTable needs at least one weight");
+    double sum = 0.0;
+    for (const double w : weights) {
+        sum += w;
+    }
+
+    // columns below the average are topped up by one above it, which then moves to whichever list it now falls in.
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * static_cast<double>(n) / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        threshold[s] = static_cast<uint64_t>(scaled[s] * 4294967296.0);
+        alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // whatever is left is 1 up to rounding and always keeps its column.
+    for (const uint32_t i : small) {
+        threshold[i] = 1ULL << 32;
+        alias[i] = i;
+    }
+    for (const uint32_t i : large) {
+        threshold[i] = 1ULL << 32;
+        alias[i] = i;
+    }
+}
+
+void generateWorkload(int* data, const size_t size, const int maxVal, const Distribution distribution, const uint64_t seed, ThreadPool& pool,
+                      const double meanRun) {
+    if (maxVal <= 0) throw std::invalid_argument("generateWorkload needs at least one bin");
+    const auto bins = static_cast<uint32_t>(maxVal);
+    const uint64_t values = streamKey(seed, Values);
+    const uint64_t breaks = streamKey(seed, RunBreaks);
+
+    // only built for the distributions that sample through it.
+    AliasTable table(distribution == Distribution::Zipf   ? zipfWeights(bins, 1.1) :
+                     distribution == Distribution::Normal ? normalWeights(bins) :
+                     distribution == Distribution::Skewed ? skewedWeights(bins, 4) : std::vector<double>{1.0});
+    // a run ends after an element with probability 1 / meanRun.
+    const uint64_t breakBelow = meanRun <= 1.0 ? UINT64_MAX : static_cast<uint64_t>(std::ldexp(1.0 / meanRun, 64));
+    const uint32_t singleBin = randomBin(counterRandom(values, 0), bins);
+
+    pool.parallel_for(0, size, WORKLOAD_GRAIN, [=, &table](const size_t begin, const size_t end) {
+        switch (distribution) {
+            case Distribution::Uniform:
+                for (size_t i = begin; i < end; ++i) {
+                    data[i] = static_cast<int>(randomBin(counterRandom(values, i), bins));
+                }
+                break;
+            case Distribution::Zipf:
+            case Distribution::Normal:
+            case Distribution::Skewed:
+                for (size_t i = begin; i < end; ++i) {
+                    data[i] = static_cast<int>(table(counterRandom(values, i)));
+                }
+                break;
+            case Distribution::Sorted:
+                // size * maxVal stays far below 2^64 for every size this runs.
+                for (size_t i = begin; i < end; ++i) {
+                    data[i] = static_cast<int>(static_cast<uint64_t>(i) * bins / size);
+                }
+                break;
+            case Distribution::Clustered: {
+                // a run's value is drawn at its first element; walk back to the start of the run we begin in.
+                size_t runStart = begin;
+                while (runStart > 0 && counterRandom(breaks, runStart - 1) >= breakBelow) {
+                    --runStart;
+                }
+                int value = static_cast<int>(randomBin(counterRandom(values, runStart), bins));
+                for (size_t i = begin; i < end; ++i) {
+                    if (i > 0 && counterRandom(breaks, i - 1) < breakBelow) {
+                        value = static_cast<int>(randomBin(counterRandom(values, i), bins));
+                    }
+                    data[i] = value;
+                }
+                break;
+            }
+            case Distribution::SingleBin:
+                std::fill(data + begin, data + end, static_cast<int>(singleBin));
+                break;
+        }
+    }).wait();
+}
@@ -0,0 +1,87 @@
+//
+// Created by Steven Roddan on 10/17/2026.
+//
+
+#ifndef CUDAHISTOGRAMS_WORKLOADGENERATOR_HPP
+#define CUDAHISTOGRAMS_WORKLOADGENERATOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+constexpr uint64_t DEFAULT_WORKLOAD_SEED = 0x5eed;
+// elements per generator task, any split gives the same data.
+constexpr size_t WORKLOAD_GRAIN = 1 << 20;
+
+enum class Distribution {
+    Uniform,
+    Zipf,      // bin b with weight 1 / (b + 1)^1.1, bin 0 hottest
+    Normal,    // discretized normal, mean maxVal / 2 and sigma maxVal / 8
+    Sorted,    // ascending, every bin equally often
+    Clustered, // runs of one uniform bin, geometric lengths of mean meanRun
+    SingleBin, // every element in one bin picked by the seed
+    Skewed     // half the elements on 4 hot bins maxVal / 4 apart, the rest uniform
+};
+
+const char* distributionName(Distribution distribution);
+
+// counter based stream: element i of stream s only depends on (seed, s, i), never on what came before,
+// so any thread can generate any range and the data is the same at every thread count.
+inline uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t streamKey(const uint64_t seed, const uint64_t stream) {
+    return mix64(seed + stream * 0xd1b54a32d192ed03ULL);
+}
+
+inline uint64_t counterRandom(const uint64_t key, const uint64_t counter) {
+    return mix64(key + (counter + 1) * 0x9e3779b97f4a7c15ULL);
+}
+
+// top 32 bits scaled into [0, bins), bins < 2^32.
+inline uint32_t randomBin(const uint64_t random, const uint32_t bins) {
+    return static_cast<uint32_t>(((random >> 32) * bins) >> 32);
+}
+
+// top 53 bits as a double in [0, 1).
+inline double unitRandom(const uint64_t random) {
+    return static_cast<double>(random >> 11) * 0x1.0p-53;
+}
+
+// Walker/Vose alias table: one random number picks a column and a coin, so any discrete distribution over
+// the bins costs the same as a uniform one to sample.
+class AliasTable {
+    std::vector<uint64_t> threshold; // coin < threshold keeps the column, scaled to 2^32
+    std::vector<uint32_t> alias;
+
+public:
+    explicit AliasTable(const std::vector<double>& weights);
+
+    uint32_t operator()(const uint64_t random) const {
+        const uint32_t column = randomBin(random, static_cast<uint32_t>(alias.size()));
+        return (random & 0xffffffffULL) < threshold[column] ? column : alias[column];
+    }
+};
+
+// fills data[0, size) with values in [0, maxVal) in parallel over the pool. The same seed gives the same
+// data for any pool size.
+void generateWorkload(int* data, size_t size, int maxVal, Distribution distribution, uint64_t seed, ThreadPool& pool,
+                      double meanRun = 64.0);
+
+// out[i] = fn(counterRandom(streamKey(seed, stream), i)) for i in [0, size), in parallel over the pool, for
+// inputs none of the distributions describe. generateWorkload draws from streams 1 and 2 of its seed.
+template<typename T, typename F>
+void generateStream(T* out, const size_t size, const uint64_t seed, const uint64_t stream, ThreadPool& pool, const F& fn) {
+    const uint64_t key = streamKey(seed, stream);
+    pool.parallel_for(0, size, WORKLOAD_GRAIN, [=, &fn](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            out[i] = fn(counterRandom(key, i));
+        }
+    }).wait();
+}
+
+#endif //CUDAHISTOGRAMS_WORKLOADGENERATOR_HPP
@@ -3,29 +3,78 @@
 #include "NaiveThreadedHistogram.hpp"
 #include "ThreadedChunkedHistogram.hpp"
 #include "ThreadPool.hpp"
+#include "WorkStealingPool.hpp"
 #include "ThreadedReducedHistogram.hpp"
+#include "ThreadedNarrowHistogram.hpp"
+#include "AtomicHistogram.hpp"
+#include "BinnedHistogram.hpp"
+#include "JointHistogram.hpp"
+#include "HistogramPlanner.hpp"
+#include "SimdHistogram.hpp"
+#include "WeightedHistogram.hpp"
+#include "SparseHistogram.hpp"
+#include "WindowedHistogram.hpp"
+#include "HistogramIndex.hpp"
+#include "PackedInput.hpp"
+#include "WorkloadGenerator.hpp"
+#include "RunAwareHistogram.hpp"
+#include "FusedHistogram.hpp"
+#include "ShardedHistogram.hpp"
+#include "BenchmarkStats.hpp"
+#include "PartitionedHistogram.hpp"
+#include "HistogramStream.hpp"
+#include "HistogramWorkspace.hpp"
+#include "MappedInput.hpp"
 #include "TableStats.hpp"
+#include "BenchmarkResults.hpp"
 
 #include <cuda_runtime.h>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <locale>
 #include <memory>
-#include <random>
 #include <sstream>
+#include <string_view>
 
 constexpr size_t iterations = 10;
 constexpr size_t smallDataSize = 100000;
 constexpr size_t mediumDataSize = smallDataSize * 100;
 constexpr size_t largeDataSize = mediumDataSize * 100;
+constexpr size_t fineGrain = 1 << 16;
 // constexpr size_t hugeDataSize = largeDataSize * 10;
 
 std::vector V_TEST_SIZES = {largeDataSize};
 std::vector V_BIN_SIZES = {512, 1024, 2048, 4096, 32768, 131072};
 //std::vector V_BIN_SIZES = {128, 256};
-std::vector V_THREAD_COUNTS = {8, 16, 32, 64};
+std::vector V_THREAD_COUNTS = {8, 16, 24, 32, 48, 64};
 //std::vector V_THREAD_COUNTS = {8, 16, 32};
+std::vector V_DISTRIBUTIONS = {Distribution::Uniform, Distribution::Zipf, Distribution::Normal,
+                               Distribution::Sorted, Distribution::Clustered, Distribution::SingleBin};
+//std::vector V_DISTRIBUTIONS = {Distribution::Uniform};
+
+// every generated input derives from this, `--seed` changes it.
+uint64_t workloadSeed = DEFAULT_WORKLOAD_SEED;
+
+// generateStream streams of the side benchmarks' inputs, clear of the ones generateWorkload uses.
+enum SideStream : uint64_t {
+    ShortStream = 16,
+    FloatStream,
+    EdgeStream,
+    ChannelStream,
+    BytesStream,
+    LatencyStream,
+    PickStream
+};
+
+// generation only, sized to the machine rather than to the thread count being timed.
+ThreadPool& generatorPool() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
 
 std::string comma_separate(const size_t value) {
     std::ostringstream oss;
@@ -36,15 +85,385 @@ std::string comma_separate(const size_t value) {
 
 template<typename T>
 void generateRandomIntArray(const T& ptr,  const size_t size, const int maxVal) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution dis(0, maxVal-1);
+    generateWorkload(ptr.get(), size, maxVal, Distribution::Uniform, workloadSeed, generatorPool());
+}
+
+// half of the elements land on a handful of hot bins, the rest is uniform. Models the hot bin contention
+// the shared histogram solvers have to survive.
+template<typename T>
+void generateSkewedIntArray(const T& ptr, const size_t size, const int maxVal) {
+    generateWorkload(ptr.get(), size, maxVal, Distribution::Skewed, workloadSeed, generatorPool());
+}
+
+// shared histogram solvers on uniform and skewed data. The mutex solver is way too slow for the large
+// runs, so this uses the medium data size.
+void runSharedHistogramBenchmark() {
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize], std::default_delete<int[]>());
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        for (const bool skewed : {false, true}) {
+            const std::string suffix = skewed ? " [skewed]" : " [uniform]";
+            std::cout << "Testing shared [" << "BinSize: " << binSize << ", " << "DataSize: " << testSize << "]" << suffix << " -> status..." << std::flush;
+            timing::currentWorkload() = distributionName(skewed ? Distribution::Skewed : Distribution::Uniform);
+            if (skewed) {
+                generateSkewedIntArray(data, testSize, binSize);
+            } else {
+                generateRandomIntArray(data, testSize, binSize);
+            }
+
+            const std::shared_ptr<int[]> truthHistogram(new int[binSize]);
+            const std::shared_ptr<int[]> testHistogram(new int[binSize]);
+            clear(truthHistogram.get(), binSize);
+            solveNaiveHistogram(data, truthHistogram, testSize);
+
+            profile_threaded_naive_cpu_histogram(data, truthHistogram, testHistogram, testSize, binSize, "Naive Threaded CPU-Histogram" + suffix, iterations);
+            for (const auto& threadCount : V_THREAD_COUNTS) {
+                ThreadPool pool(threadCount);
+                profile_threaded_atomic_cpu_histogram<false>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Atomic Shared CPU-Histogram" + suffix, iterations, pool);
+                profile_threaded_atomic_cpu_histogram<true>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Atomic Shared CPU-Histogram With Hot Bins" + suffix, iterations, pool);
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram" + suffix, iterations, pool);
+            }
+            std::cout << "finished." << std::endl;
+        }
+    }
+    timing::currentWorkload() = distributionName(Distribution::Uniform);
+}
+
+// checks a binned solver against the single threaded mapping, then runs it at every thread count.
+template<typename T, typename Mapper>
+void runBinnedCase(const std::shared_ptr<T[]>& data, const size_t testSize, const Mapper& mapper, const std::string& testName) {
+    const size_t bins = mapper.histogramSize();
+    const std::shared_ptr<int[]> truthHistogram(new int[bins]);
+    const std::shared_ptr<int[]> testHistogram(new int[bins]);
+    clear(truthHistogram.get(), bins);
+    solveBinnedNaiveHistogram(data.get(), truthHistogram, testSize, mapper);
+
+    for (const auto& threadCount : V_THREAD_COUNTS) {
+        ThreadPool pool(threadCount);
+        profile_threaded_binned_cpu_histogram(data, truthHistogram, testHistogram, testSize, mapper, threadCount, testName, iterations, pool);
+    }
+}
+
+// narrow integer and floating point inputs through the bin mappers, medium size like the shared benchmark.
+void runBinnedHistogramBenchmark() {
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<uint16_t[]> shorts(new uint16_t[testSize]);
+    const std::shared_ptr<float[]> floats(new float[testSize]);
+
+    generateStream(shorts.get(), testSize, workloadSeed, ShortStream, generatorPool(), [](const uint64_t random) {
+        return static_cast<uint16_t>(random >> 48);
+    });
+    // a little out of range on both sides
+    generateStream(floats.get(), testSize, workloadSeed, FloatStream, generatorPool(), [](const uint64_t random) {
+        return static_cast<float>(-0.05 + 1.1 * unitRandom(random));
+    });
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        std::cout << "Testing binned [" << "BinSize: " << binSize << ", " << "DataSize: " << testSize << "] -> status..." << std::flush;
+
+        if (binSize <= 65536) {
+            // identity needs the values below binSize, so that case gets its own copy.
+            const std::shared_ptr<uint16_t[]> ids(new uint16_t[testSize]);
+            for (size_t i = 0; i < testSize; ++i) {
+                ids[i] = static_cast<uint16_t>(shorts[i] % binSize);
+            }
+            runBinnedCase(ids, testSize, IdentityMapper<uint16_t>(binSize), "Threaded Binned CPU-Histogram (u16 identity)");
+        }
+        runBinnedCase(shorts, testSize, UniformMapper<uint16_t>(0.0, 65536.0, binSize), "Threaded Binned CPU-Histogram (u16 uniform)");
+        runBinnedCase(floats, testSize, UniformMapper<float, OutOfRange::Count>(0.0, 1.0, binSize),
+                      "Threaded Binned CPU-Histogram (f32 uniform, under/overflow)");
+
+        // random but sorted edges over [0, 1).
+        std::vector<double> edges(binSize + 1);
+        generateStream(edges.data(), edges.size(), workloadSeed, EdgeStream, generatorPool(), unitRandom);
+        edges.front() = 0.0;
+        edges.back() = 1.0;
+        std::sort(edges.begin(), edges.end());
+        runBinnedCase(floats, testSize, EdgesMapper<float, OutOfRange::Count>(edges),
+                      "Threaded Binned CPU-Histogram (f32 edges, under/overflow)");
+
+        std::cout << "finished." << std::endl;
+    }
+}
+
+// value x channel joint histograms, planned tiles against one private histogram per thread. At the large
+// bin sizes the joint space no longer fits in L2, which is where the tiles should pay off.
+void runJointHistogramBenchmark() {
+    constexpr size_t channels = 16;
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> values(new int[testSize]);
+    const std::shared_ptr<uint8_t[]> channel(new uint8_t[testSize]);
 
-    for (size_t i = 0; i < size; ++i) {
-        ptr[i] = dis(gen);
+    generateStream(channel.get(), testSize, workloadSeed, ChannelStream, generatorPool(), [](const uint64_t random) {
+        return static_cast<uint8_t>(randomBin(random, channels));
+    });
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        std::cout << "Testing joint [" << "BinSize: " << binSize << " x " << channels << ", " << "DataSize: " << testSize << "] -> status..." << std::flush;
+        generateRandomIntArray(values, testSize, binSize);
+
+        const auto valueAxis = makeJointAxis(values, binSize);
+        const auto channelAxis = makeJointAxis(channel, IdentityMapper<uint8_t>(channels));
+        const size_t jointBins = jointBinCount(valueAxis, channelAxis);
+
+        const std::shared_ptr<int[]> truthHistogram(new int[jointBins]);
+        const std::shared_ptr<int[]> testHistogram(new int[jointBins]);
+        clear(truthHistogram.get(), jointBins);
+        solveJointNaiveHistogram(truthHistogram, testSize, valueAxis, channelAxis);
+
+        for (const auto& threadCount : V_THREAD_COUNTS) {
+            ThreadPool pool(threadCount);
+            profile_threaded_joint_cpu_histogram(truthHistogram, testHistogram, testSize, threadCount, machineInfo().l2Bytes / 2,
+                                                 "Threaded Joint CPU-Histogram (value x channel, L2 tiles)", iterations, pool, valueAxis, channelAxis);
+            profile_threaded_joint_cpu_histogram(truthHistogram, testHistogram, testSize, threadCount, SIZE_MAX,
+                                                 "Threaded Joint CPU-Histogram (value x channel, untiled)", iterations, pool, valueAxis, channelAxis);
+        }
+        std::cout << "finished." << std::endl;
+    }
+}
+
+// bytes per bin (int weights) and latency per bin (float weights), the scalar loop against the threaded lane
+// accumulators with and without AVX-512.
+void runWeightedHistogramBenchmark() {
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize]);
+    const std::shared_ptr<int[]> bytes(new int[testSize]);
+    const std::shared_ptr<float[]> latency(new float[testSize]);
+
+    generateStream(bytes.get(), testSize, workloadSeed, BytesStream, generatorPool(), [](const uint64_t random) {
+        return 64 + static_cast<int>(randomBin(random, 1500 - 64 + 1));
+    });
+    // exponential with mean 1 by inversion.
+    generateStream(latency.get(), testSize, workloadSeed, LatencyStream, generatorPool(), [](const uint64_t random) {
+        return static_cast<float>(-std::log1p(-unitRandom(random)));
+    });
+
+    const SimdLevel detected = detectSimdLevel();
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    if (detected == SimdLevel::AVX512) levels.push_back(detected);
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        std::cout << "Testing weighted [" << "BinSize: " << binSize << ", " << "DataSize: " << testSize << "] -> status..." << std::flush;
+        generateRandomIntArray(data, testSize, binSize);
+
+        const std::shared_ptr<int64_t[]> truthBytes(new int64_t[binSize]());
+        const std::shared_ptr<int64_t[]> testBytes(new int64_t[binSize]());
+        const std::shared_ptr<double[]> truthLatency(new double[binSize]());
+        const std::shared_ptr<double[]> testLatency(new double[binSize]());
+        solveWeightedNaiveHistogram(data, bytes, truthBytes, testSize);
+        solveWeightedNaiveHistogram(data, latency, truthLatency, testSize);
+
+        profile_naive_weighted_cpu_histogram(data, bytes, truthBytes, testBytes, testSize, binSize, "Naive Weighted CPU-Histogram (i32 -> i64)", iterations);
+        profile_naive_weighted_cpu_histogram(data, latency, truthLatency, testLatency, testSize, binSize, "Naive Weighted CPU-Histogram (f32 -> f64)", iterations);
+
+        for (const auto& threadCount : V_THREAD_COUNTS) {
+            ThreadPool pool(threadCount);
+            for (const auto level : levels) {
+                const std::string suffix = std::string(", ") + simdLevelName(level) + ")";
+                profile_threaded_weighted_cpu_histogram(data, bytes, truthBytes, testBytes, testSize, binSize, threadCount,
+                                                        "Threaded Weighted CPU-Histogram (i32 -> i64" + suffix, iterations, pool, level);
+                profile_threaded_weighted_cpu_histogram(data, latency, truthLatency, testLatency, testSize, binSize, threadCount,
+                                                        "Threaded Weighted CPU-Histogram (f32 -> f64" + suffix, iterations, pool, level);
+            }
+        }
+        std::cout << "finished." << std::endl;
+    }
+}
+
+// IDs from a 16M key space where only a few of them show up. A dense private histogram per thread would be
+// 64MB, the sparse tables only grow with the keys that actually occur.
+void runSparseHistogramBenchmark() {
+    constexpr size_t keySpace = 1 << 24;
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize]);
+    const std::shared_ptr<int[]> truthHistogram(new int[keySpace]);
+    const std::shared_ptr<int[]> testHistogram(new int[keySpace]);
+
+    for (const size_t activeKeys : {1024, 16384, 262144}) {
+        std::cout << "Testing sparse [" << "Keys: " << activeKeys << " of " << keySpace << ", " << "DataSize: " << testSize << "] -> status..." << std::flush;
+        const std::shared_ptr<int[]> ids(new int[activeKeys]);
+        generateRandomIntArray(ids, activeKeys, keySpace);
+        generateStream(data.get(), testSize, workloadSeed, PickStream, generatorPool(), [&ids, activeKeys](const uint64_t random) {
+            return ids[randomBin(random, static_cast<uint32_t>(activeKeys))];
+        });
+
+        clear(truthHistogram.get(), keySpace);
+        solveNaiveHistogram(data, truthHistogram, testSize);
+
+        const size_t estimate = estimateDistinctKeys(data.get(), testSize, keySpace);
+        std::cout << "[~" << estimate << " keys -> " << histogramOutputName(selectHistogramOutput(estimate, keySpace)) << "] " << std::flush;
+
+        for (const auto& threadCount : V_THREAD_COUNTS) {
+            ThreadPool pool(threadCount);
+            const std::string suffix = " [" + std::to_string(activeKeys) + " keys]";
+            profile_threaded_sparse_cpu_histogram(data, truthHistogram, testHistogram, testSize, keySpace, threadCount, false,
+                                                  "Threaded Sparse CPU-Histogram" + suffix, iterations, pool);
+            profile_threaded_sparse_cpu_histogram(data, truthHistogram, testHistogram, testSize, keySpace, threadCount, true,
+                                                  "Threaded Sparse CPU-Histogram To Dense" + suffix, iterations, pool);
+        }
+        std::cout << "finished." << std::endl;
+    }
+}
+
+// a window of the last 16 buckets of 64K elements, read after every bucket: incremental against rebuilding
+// the window with the reduced solver each tick, plus the decayed variant.
+void runWindowedHistogramBenchmark() {
+    constexpr size_t buckets = 16;
+    constexpr size_t bucketElements = 1 << 16;
+    constexpr double halfLifeBuckets = 4.0;
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize]);
+    const size_t sealed = testSize / bucketElements * bucketElements;
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        std::cout << "Testing windowed [" << "BinSize: " << binSize << ", " << "Window: " << buckets << " x " << bucketElements << ", "
+                  << "DataSize: " << testSize << "] -> status..." << std::flush;
+        generateRandomIntArray(data, testSize, binSize);
+
+        const std::shared_ptr<int[]> truthHistogram(new int[binSize]);
+        const std::shared_ptr<int[]> testHistogram(new int[binSize]);
+        clear(truthHistogram.get(), binSize);
+        const size_t windowStart = sealed - std::min(sealed, buckets * bucketElements);
+        solveNaiveHistogram(std::shared_ptr<int[]>(data, data.get() + windowStart), truthHistogram, sealed - windowStart);
+
+        const std::shared_ptr<double[]> truthDecayed(new double[binSize]());
+        const std::shared_ptr<double[]> testDecayed(new double[binSize]());
+        solveDecayedNaiveHistogram(data, truthDecayed, testSize, binSize, bucketElements, std::exp2(-1.0 / halfLifeBuckets));
+
+        for (const auto& threadCount : V_THREAD_COUNTS) {
+            ThreadPool pool(threadCount);
+            profile_windowed_cpu_histogram(data, truthHistogram, testHistogram, testSize, binSize, buckets, bucketElements, threadCount,
+                                           "Windowed CPU-Histogram (incremental)", iterations, pool);
+            profile_windowed_rebuild_cpu_histogram(data, truthHistogram, testHistogram, testSize, binSize, buckets, bucketElements, threadCount,
+                                                   "Windowed CPU-Histogram (rebuild per tick)", iterations, pool);
+            profile_decayed_cpu_histogram(data, truthDecayed, testDecayed, testSize, binSize, halfLifeBuckets, bucketElements, threadCount,
+                                          "Decayed CPU-Histogram", iterations, pool);
+        }
+        std::cout << "finished." << std::endl;
+    }
+}
+
+// prefix sum index over a finished histogram: building it, 4096 quantile + range queries against linear
+// scans, and updating it after a merge touched 8 bins.
+void runHistogramIndexBenchmark() {
+    constexpr size_t queryCount = 4096;
+    constexpr size_t changedBins = 8;
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize]);
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        std::cout << "Testing index [" << "BinSize: " << binSize << ", " << "Queries: " << queryCount << "] -> status..." << std::flush;
+        generateRandomIntArray(data, testSize, binSize);
+        const std::shared_ptr<int[]> histogram(new int[binSize]);
+        clear(histogram.get(), binSize);
+        solveNaiveHistogram(data, histogram, testSize);
+
+        ThreadPool single(1);
+        profile_histogram_index_build(histogram, binSize, 1, "Histogram Index Build", iterations, single);
+        for (const auto& threadCount : V_THREAD_COUNTS) {
+            ThreadPool pool(threadCount);
+            profile_histogram_index_build(histogram, binSize, threadCount, "Histogram Index Build", iterations, pool);
+        }
+        profile_histogram_index_queries(histogram, binSize, queryCount, true, "Histogram Index Queries", iterations);
+        profile_histogram_index_queries(histogram, binSize, queryCount, false, "Linear Scan Queries", iterations);
+        profile_histogram_index_update(histogram, binSize, changedBins, "Histogram Index Update", iterations);
+        std::cout << "finished." << std::endl;
     }
 }
 
+// runs of one random value with geometric lengths averaging meanRun, clustered telemetry style input.
+template<typename T>
+void generateClusteredIntArray(const T& ptr, const size_t size, const int maxVal, const double meanRun = 64.0) {
+    generateWorkload(ptr.get(), size, maxVal, Distribution::Clustered, workloadSeed, generatorPool(), meanRun);
+}
+
+// bit packed and run length input against the int layout. Every row keeps 4 bytes per element for its
+// GB/s, so the column is the effective bandwidth of the int layout.
+void runPackedInputBenchmark() {
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize]);
+    const SimdLevel detected = detectSimdLevel();
+
+    for (const auto& binSize : V_BIN_SIZES) {
+        for (const bool clustered : {false, true}) {
+            const std::string suffix = clustered ? " [clustered]" : " [uniform]";
+            timing::currentWorkload() = distributionName(clustered ? Distribution::Clustered : Distribution::Uniform);
+            if (clustered) {
+                generateClusteredIntArray(data, testSize, binSize);
+            } else {
+                generateRandomIntArray(data, testSize, binSize);
+            }
+
+            const unsigned bits = PackedArray::bitsFor(binSize);
+            const PackedArray packed(data.get(), testSize, bits);
+            const RunLengthArray runLength(data.get(), testSize, bits);
+            const InputEncoding encoding = selectInputEncoding(testSize, runLength.runs(), bits);
+            const double intBytes = static_cast<double>(testSize * sizeof(int));
+            std::cout << "Testing packed [" << "BinSize: " << binSize << ", " << "DataSize: " << testSize << "]" << suffix
+                      << " [" << bits << " bits " << intBytes / static_cast<double>(packed.sizeBytes()) << "x, run length "
+                      << intBytes / static_cast<double>(runLength.sizeBytes()) << "x -> " << inputEncodingName(encoding) << "] -> status..." << std::flush;
+
+            const std::shared_ptr<int[]> truthHistogram(new int[binSize]);
+            const std::shared_ptr<int[]> testHistogram(new int[binSize]);
+            clear(truthHistogram.get(), binSize);
+            solveNaiveHistogram(data, truthHistogram, testSize);
+
+            for (const auto& threadCount : V_THREAD_COUNTS) {
+                ThreadPool pool(threadCount);
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced>(data, truthHistogram, testHistogram,
+                    testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram (int32 input)" + suffix, iterations, pool);
+                profile_threaded_packed_cpu_histogram(packed, truthHistogram, testHistogram, binSize, threadCount,
+                                                      "Threaded Packed CPU-Histogram (Scalar)" + suffix, iterations, pool, SimdLevel::Scalar);
+                if (detected == SimdLevel::AVX512) {
+                    profile_threaded_packed_cpu_histogram(packed, truthHistogram, testHistogram, binSize, threadCount,
+                                                          "Threaded Packed CPU-Histogram (AVX-512)" + suffix, iterations, pool, detected);
+                }
+                if (clustered) {
+                    profile_threaded_run_length_cpu_histogram(runLength, truthHistogram, testHistogram, binSize, threadCount,
+                                                              "Threaded Run-Length CPU-Histogram" + suffix, iterations, pool);
+                }
+            }
+            std::cout << "finished." << std::endl;
+        }
+    }
+    timing::currentWorkload() = distributionName(Distribution::Uniform);
+}
+
+// one column at 512, 4096 and 131072 bins: fused into one scan against one binned solve per resolution.
+// The fused pass runs with the default private budget (the 131072 bin histogram goes shared) and with
+// everything private.
+void runFusedHistogramBenchmark() {
+    constexpr int valueRange = 131072;
+    const size_t testSize = mediumDataSize;
+    const std::shared_ptr<int[]> data(new int[testSize]);
+    generateRandomIntArray(data, testSize, valueRange);
+
+    std::vector<UniformMapper<int>> mappers;
+    for (const size_t bins : {512, 4096, 131072}) {
+        mappers.emplace_back(0.0, static_cast<double>(valueRange), bins);
+    }
+    std::vector<std::shared_ptr<int[]>> truthHistograms;
+    for (const auto& mapper : mappers) {
+        truthHistograms.emplace_back(new int[mapper.histogramSize()]);
+        clear(truthHistograms.back().get(), mapper.histogramSize());
+        solveBinnedNaiveHistogram(data.get(), truthHistograms.back(), testSize, mapper);
+    }
+
+    std::cout << "Testing fused [" << "BinSizes: 512/4096/131072, " << "DataSize: " << testSize << "] -> status..." << std::flush;
+    for (const auto& threadCount : V_THREAD_COUNTS) {
+        ThreadPool pool(threadCount);
+        profile_separate_cpu_histograms(data, truthHistograms, testSize, mappers, threadCount, "Separate Binned CPU-Histograms (512/4096/131072)", iterations, pool);
+        profile_fused_cpu_histograms(data, truthHistograms, testSize, mappers, threadCount, "Fused CPU-Histograms (512/4096/131072)", iterations, pool);
+        profile_fused_cpu_histograms(data, truthHistograms, testSize, mappers, threadCount, "Fused CPU-Histograms (512/4096/131072, all private)", iterations, pool,
+                                     std::numeric_limits<size_t>::max());
+    }
+    std::cout << "finished." << std::endl;
+}
+
 int x = 0;
 std::mutex test_mutex;
 
@@ -55,18 +474,177 @@ void foo() {
     }
 }
 
-int main() {
+template<typename T>
+bool mappedTruthHistogram(const MappedInputFile& file, const std::shared_ptr<int[]>& truthHistogram, const int maxVal) {
+    const T* values = file.data<T>();
+    for (size_t i = 0; i < file.size(); ++i) {
+        if (static_cast<int64_t>(values[i]) < 0 || static_cast<int64_t>(values[i]) >= maxVal) {
+            std::cerr << "Value " << static_cast<int64_t>(values[i]) << " at element " << i << " is outside [0, " << maxVal << ")" << std::endl;
+            return false;
+        }
+        ++truthHistogram[values[i]];
+    }
+    return true;
+}
+
+// runs the threaded solvers against a raw binary file, e.g. `CudaHistograms --file data.bin --bins 4096 --width 2`.
+// --shards N adds the same file counted by N worker processes with threadCount / N threads each.
+int runMappedFileBenchmark(const std::string& path, const int maxVal, const ElementWidth width, const size_t shards) {
+    std::shared_ptr<MappedInputFile> file;
+    try {
+        file = std::make_shared<MappedInputFile>(path, width);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Testing [" << "File: " << path << ", " << "Elements: " << comma_separate(file->size()) << ", "
+              << "Width: " << static_cast<size_t>(width) << "B, BinSize: " << maxVal << "]" << std::endl;
+
+    const std::shared_ptr<int[]> truthHistogram(new int[maxVal]);
+    const std::shared_ptr<int[]> testHistogram(new int[maxVal]);
+    clear(truthHistogram.get(), maxVal);
+
+    bool inRange = false;
+    switch (width) {
+        case ElementWidth::U8:  inRange = mappedTruthHistogram<uint8_t>(*file, truthHistogram, maxVal);  break;
+        case ElementWidth::U16: inRange = mappedTruthHistogram<uint16_t>(*file, truthHistogram, maxVal); break;
+        case ElementWidth::I32: inRange = mappedTruthHistogram<int32_t>(*file, truthHistogram, maxVal);  break;
+    }
+    if (!inRange) return 1;
+
+    timing::currentWorkload() = "file";
+    const size_t dataSize = file->size();
+    for (const auto& threadCount : V_THREAD_COUNTS) {
+        ThreadPool pool(threadCount);
+        profile_mapped_cpu_histogram(*file, truthHistogram, testHistogram, maxVal, threadCount, "Mapped File CPU-Histogram", iterations, pool);
+
+        // only int32 files line up with the int based solvers, these read the mapping with no copy as well.
+        if (width == ElementWidth::I32) {
+            const std::shared_ptr<int[]> data = mappedIntArray(file);
+            profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced>(data, truthHistogram, testHistogram,
+                                                    dataSize, maxVal, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram (mapped)", iterations, pool);
+            profile_threaded_simd_cpu_histogram(data, truthHistogram, testHistogram,
+                                                    dataSize, maxVal, threadCount, "Threaded SIMD CPU-Histogram (mapped)", iterations, pool);
+            profile_threaded_partitioned_cpu_histogram(data, truthHistogram, testHistogram,
+                                                    dataSize, maxVal, threadCount, "Threaded Partitioned CPU-Histogram (mapped)", iterations, pool);
+        }
+
+        if (shards > 1 && static_cast<size_t>(threadCount) >= shards) {
+            // the shards only use a multiple of shards threads, the comparison below needs a one process row with that total.
+            const size_t shardedThreads = static_cast<size_t>(threadCount) / shards * shards;
+            if (std::find(V_THREAD_COUNTS.begin(), V_THREAD_COUNTS.end(), static_cast<int>(shardedThreads)) == V_THREAD_COUNTS.end()) {
+                profile_mapped_cpu_histogram(*file, truthHistogram, testHistogram, maxVal, shardedThreads, "Mapped File CPU-Histogram", iterations, pool);
+            }
+            profile_sharded_file_cpu_histogram(path, width, truthHistogram, testHistogram, dataSize, maxVal, shards, shardedThreads / shards,
+                                               "Sharded File CPU-Histogram (" + std::to_string(shards) + " shards)", iterations, pool);
+        }
+    }
+
+    // process start up and the merge against one process with the same threads.
+    if (shards > 1) {
+        std::lock_guard<std::mutex> lock(timing::mutex());
+        const std::string shardedName = "Sharded File CPU-Histogram (" + std::to_string(shards) + " shards)";
+        for (const auto& threadCount : V_THREAD_COUNTS) {
+            const size_t perShard = static_cast<size_t>(threadCount) / shards;
+            const auto single = timing::samples().find({"Mapped File CPU-Histogram", static_cast<size_t>(maxVal), dataSize, perShard * shards});
+            const auto sharded = timing::samples().find({shardedName, static_cast<size_t>(maxVal), dataSize, perShard * shards});
+            if (single == timing::samples().end() || sharded == timing::samples().end()) continue;
+            const double singleMs = stats::summarize(single->second).median;
+            const double shardedMs = stats::summarize(sharded->second).median;
+            std::cout << shards << " shards x " << perShard << " threads: " << shardedMs << " ms vs " << singleMs << " ms in one process ("
+                      << singleMs / shardedMs << "x)" << std::endl;
+        }
+    }
+
+    // the table's GB/s column reads the element width from here, every row above reads the file as is.
+    {
+        std::lock_guard<std::mutex> lock(timing::mutex());
+        for (const auto& [key, time] : timing::totals()) {
+            timing::elementBytes()[key] = static_cast<size_t>(width);
+        }
+    }
+
+    TimingTablePrinter::print(std::cout);
+    if (!writeBenchmarkResults(std::string(GIT_HASH) + "_mapped_file_results", GIT_HASH)) {
+        std::cerr << "Could not write the CSV/JSON results!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(const int argc, char** argv) {
+    // spawned by runShardedHistogram, counts one range of a file and exits.
+    if (argc > 1 && std::string_view(argv[1]) == SHARD_WORKER_FLAG) {
+        return runShardWorker(argc, argv);
+    }
+    // e.g. `CudaHistograms --compare <old hash>_..._algorithm.csv <new hash>_..._algorithm.csv`, exits 1 on a regression.
+    if (argc > 1 && std::string_view(argv[1]) == "--compare") {
+        if (argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " --compare <base.csv> <candidate.csv>" << std::endl;
+            return 1;
+        }
+        try {
+            return compareBenchmarkResults(argv[2], argv[3]) > 0 ? 1 : 0;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (argc > 1 && std::string_view(argv[1]) == "--file") {
+        std::string path;
+        int bins = 0;
+        size_t widthBytes = sizeof(int);
+        size_t shards = 1;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            const std::string_view flag(argv[i]);
+            if (flag == "--file")  path = argv[i + 1];
+            else if (flag == "--bins")  bins = std::stoi(argv[i + 1]);
+            else if (flag == "--width") widthBytes = std::stoul(argv[i + 1]);
+            else if (flag == "--shards") shards = std::stoul(argv[i + 1]);
+        }
+        if (path.empty() || bins <= 0 || (widthBytes != 1 && widthBytes != 2 && widthBytes != 4) || shards == 0) {
+            std::cerr << "Usage: " << argv[0] << " --file <path> --bins <maxVal> [--width 1|2|4] [--shards N]" << std::endl;
+            return 1;
+        }
+        return runMappedFileBenchmark(path, bins, static_cast<ElementWidth>(widthBytes), shards);
+    }
+
+    // `--trace` records per worker phases and writes <hash>_..._algorithm.trace.json,
+    // `--perf` adds per element perf counter columns to the results, `--seed <n>` regenerates different inputs.
+    bool tracing = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view flag(argv[i]);
+        if (flag == "--trace") tracing = true;
+        else if (flag == "--perf") perf::setEnabled(true);
+        else if (flag == "--seed" && i + 1 < argc) workloadSeed = std::stoull(argv[++i]);
+    }
+    trace::setEnabled(tracing);
+    if (perf::enabled()) {
+        std::cout << "Perf counters: " << perf::describe() << std::endl;
+    }
+
     const auto start = std::chrono::system_clock::now();
     const std::time_t start_time = std::chrono::system_clock::to_time_t(start);
     std::cout << "Testing started at " << std::ctime(&start_time);
     std::cout << "Iterations: " << iterations << std::endl;
+    std::cout << "Workload seed: " << workloadSeed << std::endl;
+    std::cout << "SIMD level: " << simdLevelName(detectSimdLevel()) << std::endl;
+
 
+    const MachineInfo& machine = machineInfo();
+    std::cout << "Machine: " << machine.cpuModel << ", " << machine.physicalCores << " cores / " << machine.logicalCores << " threads, L1D "
+              << (machine.l1dBytes >> 10) << "K, L2 " << (machine.l2Bytes >> 10) << "K, L3 " << (machine.l3Bytes >> 10) << "K, " << machine.numaNodes << " NUMA node(s)" << std::endl;
+    HistogramPlanner planner;
 
     for (const auto& testSize : V_TEST_SIZES) {
         const std::shared_ptr<int[]> data(new int[testSize], std::default_delete<int[]>());
+        for (const auto& distribution : V_DISTRIBUTIONS)
         for (const auto& binSize : V_BIN_SIZES) {
-            std::cout << "Testing [" << "BinSize: " << binSize << ", " << "DataSize: " << testSize << "] -> status..." << std::flush;
-            generateRandomIntArray(data, testSize, binSize);
+            std::cout << "Testing [" << "BinSize: " << binSize << ", " << "DataSize: " << testSize << ", "
+                      << "Distribution: " << distributionName(distribution) << "] -> status..." << std::flush;
+            // every timing below is keyed by this workload.
+            timing::currentWorkload() = distributionName(distribution);
+            generateWorkload(data.get(), testSize, binSize, distribution, workloadSeed, generatorPool());
             const std::shared_ptr<int[]> truthHistogram(new int[binSize]);
             const std::shared_ptr<int[]> testHistogram(new int[binSize]);
 
@@ -77,6 +655,9 @@ int main() {
 
             profile_naive_cpu_histogram(data, truthHistogram, testHistogram, testSize, binSize, "Baseline", iterations);
 
+            // whatever the planner picks for this machine and bin count, tuned once and then read from the plan cache.
+            profile_planned_cpu_histogram(planner, data, truthHistogram, testHistogram, testSize, binSize, "Planned CPU-Histogram", iterations);
+
             // this test relies on lock_guards for threads accessing the histogram, it is purely dumb
             // and takes a long time to run.
             // if (testSize == *V_TEST_SIZES.begin()) {
@@ -86,33 +667,94 @@ int main() {
             for (const auto& threadCount : V_THREAD_COUNTS ) {
                 ThreadPool pool(threadCount);
 
-                profile_threaded_reduced_cpu_histogram(data, truthHistogram, testHistogram,
-                                                        testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram", iterations, pool);
-
-                // AMD ICD 0 test
-                profile_threaded_reduced_cpu_histogram<true, false, false>(data, truthHistogram, testHistogram,
-                                                        testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With CORE Affinity (8)", iterations, pool);
-                // Prefetching and Loop Unrolling
-                profile_threaded_reduced_cpu_histogram<false, true, false>(data, truthHistogram, testHistogram,
-                                                        testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Explicit PreFetch", iterations, pool);
-                // Prefetching and Loop Unrolling
-                profile_threaded_reduced_cpu_histogram<false, true, true>(data, truthHistogram, testHistogram,
-                                                        testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Explicit PreFetch & Unrolling", iterations, pool);
-                // Unrolling
-                profile_threaded_reduced_cpu_histogram<false, false, true>(data, truthHistogram, testHistogram,
-                                                        testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Unrolling", iterations, pool);
-                // Pin threads so caching isn't lost.
-                profile_threaded_reduced_cpu_histogram<false, false, false, true>(data, truthHistogram, testHistogram,
-                                                        testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Pinned threads", iterations, pool);
+                // the tree reduction pairs threads up, so it only runs on power of two thread counts.
+                if (isPowerOfTwo(threadCount)) {
+                    profile_threaded_reduced_cpu_histogram(data, truthHistogram, testHistogram,
+                                                            testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram", iterations, pool);
+
+                    // AMD ICD 0 test
+                    profile_threaded_reduced_cpu_histogram<true, false, false>(data, truthHistogram, testHistogram,
+                                                            testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With CORE Affinity (8)", iterations, pool);
+                    // Prefetching and Loop Unrolling
+                    profile_threaded_reduced_cpu_histogram<false, true, false>(data, truthHistogram, testHistogram,
+                                                            testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Explicit PreFetch", iterations, pool);
+                    // Prefetching and Loop Unrolling
+                    profile_threaded_reduced_cpu_histogram<false, true, true>(data, truthHistogram, testHistogram,
+                                                            testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Explicit PreFetch & Unrolling", iterations, pool);
+                    // Unrolling
+                    profile_threaded_reduced_cpu_histogram<false, false, true>(data, truthHistogram, testHistogram,
+                                                            testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Unrolling", iterations, pool);
+                    // Pin threads so caching isn't lost.
+                    profile_threaded_reduced_cpu_histogram<false, false, false, true>(data, truthHistogram, testHistogram,
+                                                            testSize, binSize, threadCount, "Threaded Reduction CPU-Histogram With Pinned threads", iterations, pool);
+                }
+                // Single pass bin sliced reduction, no barrier rounds and no serial copy, any thread count.
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram", iterations, pool);
+                // Same solver on a pooled huge page workspace, the reducer zeroes the private slices as it reads them.
+                profile_threaded_workspace_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Workspace Bin-Sliced CPU-Histogram", iterations, pool);
+                // Topology aware pinning from sysfs, private histograms (and on NUMA the input) first touched by their worker.
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced, PlacementPolicy::Compact>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram (Compact Placement)", iterations, pool);
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced, PlacementPolicy::Scatter>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram (Scatter Placement)", iterations, pool);
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced, PlacementPolicy::PhysicalCores>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram (Physical Core Placement)", iterations, pool);
+                // 8/16 bit private counters spilling into int32, fixed widths and the cache based default.
+                profile_threaded_narrow_cpu_histogram<uint8_t>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Narrow Reduction CPU-Histogram (u8/saturation)", iterations, pool);
+                profile_threaded_narrow_cpu_histogram<uint16_t>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Narrow Reduction CPU-Histogram (u16/saturation)", iterations, pool);
+                profile_threaded_compact_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Compact Reduction CPU-Histogram", iterations, pool,
+                                                        machineInfo().l1dBytes, machineInfo().l2Bytes);
+                // Vectorized count loop over lane-replicated sub-histograms, kernel picked through CPUID.
+                profile_threaded_simd_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, std::string("Threaded SIMD CPU-Histogram (") + simdLevelName(detectSimdLevel()) + ")", iterations, pool);
+                // Whole runs credited in one update where a block's sampled head has them (sorted/clustered workloads), the plain loop elsewhere.
+                profile_threaded_run_aware_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, std::string("Threaded Run-Aware CPU-Histogram (") + simdLevelName(detectSimdLevel()) + ")", iterations, pool);
+                // Two pass radix-style partitioning, every bucket's bins fit in L1 and need no reduction.
+                profile_threaded_partitioned_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Partitioned CPU-Histogram", iterations, pool);
+                // Same private histograms fed chunk by chunk through the double buffered stream.
+                profile_histogram_stream_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, DEFAULT_STREAM_CHUNK, "Streamed CPU-Histogram", iterations, pool);
+
+                // Head to head against the work stealing pool: the same barrier based solver, then fine grained chunks.
+                WorkStealingPool wsPool(threadCount);
+                profile_threaded_reduced_cpu_histogram<false, false, false, false, ReductionStrategy::BinSliced>(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, threadCount, "Threaded Bin-Sliced Reduction CPU-Histogram (Work-Stealing Pool)", iterations, wsPool);
+                profile_threaded_grained_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, fineGrain, "Fine Grained Reduction CPU-Histogram", iterations, pool);
+                profile_threaded_grained_cpu_histogram(data, truthHistogram, testHistogram,
+                                                        testSize, binSize, fineGrain, "Fine Grained Reduction CPU-Histogram (Work-Stealing Pool)", iterations, wsPool);
 
             }
+            // no later bin size reuses these workspaces or the planned solver's scratch.
+            workspacePool().trim();
+            planner.trim();
             std::cout << "finished." << std::endl;
         }
     }
+    // the side benchmarks run on uniform input, the shared and packed ones key their skewed and clustered
+    // inputs themselves and switch back afterwards.
+    timing::currentWorkload() = distributionName(Distribution::Uniform);
+    runSharedHistogramBenchmark();
+    runBinnedHistogramBenchmark();
+    runJointHistogramBenchmark();
+    runWeightedHistogramBenchmark();
+    runSparseHistogramBenchmark();
+    runWindowedHistogramBenchmark();
+    runHistogramIndexBenchmark();
+    runPackedInputBenchmark();
+    runFusedHistogramBenchmark();
     const auto end = std::chrono::system_clock::now();
 
 
-    std::ofstream outFile(std::string(GIT_HASH) + "_initial_thread_pool_results_on_host_reduction_algorithm.txt");
+    const std::string resultsPath = std::string(GIT_HASH) + "_initial_thread_pool_results_on_host_reduction_algorithm";
+    std::ofstream outFile(resultsPath + ".txt");
     if (!outFile) {
         std::cerr << "Could not open file for writing!" << std::endl;
         return 1;
@@ -121,6 +763,17 @@ int main() {
     outFile << GIT_HASH << "\n";
     outFile << "Iterations: " << iterations << "\n";
     TimingTablePrinter::print(outFile);
+    if (!writeBenchmarkResults(resultsPath, GIT_HASH)) {
+        std::cerr << "Could not write the CSV/JSON results!" << std::endl;
+        return 1;
+    }
+    if (tracing) {
+        trace::printImbalance(std::cout);
+        if (!trace::writeChromeTrace(resultsPath + ".trace.json")) {
+            std::cerr << "Could not write the trace!" << std::endl;
+            return 1;
+        }
+    }
     std::cout << "Total Iterations each: " << iterations << std::endl;
     const std::time_t end_time = std::chrono::system_clock::to_time_t(end);
     std::cout << "Testing finished at " << std::ctime(&end_time);